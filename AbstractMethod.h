@@ -4,6 +4,7 @@
 #include <vector>
 #include <string>
 #include <QString>
+#include "sampleview.h"
 
 struct GraphSeriesData {
     std::string name;
@@ -12,12 +13,29 @@ struct GraphSeriesData {
     bool isScatter = false;
 };
 
+// Строка таблицы квантилей: P, Xp_low, Xp, Xp_up
+struct QuantileRow {
+    double p;
+    double low;
+    double est;
+    double up;
+};
+
+// Результат расчета. Метод возвращает его по значению и ничего не запоминает,
+// поэтому один зарегистрированный экземпляр можно вызывать из многих потоков.
+struct MethodResult {
+    QString report;
+    std::vector<double> params;            // оценки параметров (c, b / a, sigma / ...)
+    std::vector<std::vector<double>> cov;  // ковариационная матрица оценок
+    std::vector<QuantileRow> quantiles;
+    std::vector<GraphSeriesData> graph;    // заполняется только при withGraph
+};
+
 class AbstractMethod {
 public:
     virtual ~AbstractMethod() {}
-    virtual QString calculate(const std::vector<double>& data, const std::vector<int>& cens) = 0;
-    virtual bool hasGraph() { return false; } // Без const
-    virtual std::vector<GraphSeriesData> getGraphData() = 0;
+    virtual MethodResult calculate(DataView data, CensView cens, bool withGraph) const = 0;
+    virtual bool hasGraph() const { return false; }
 };
 
 #endif
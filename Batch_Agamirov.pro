@@ -0,0 +1,73 @@
+QT       += core
+QT       -= gui
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = Batch_Agamirov
+
+SOURCES += \
+    analysis.cpp \
+    batch_main.cpp \
+    binarysample.cpp \
+    bootstrap.cpp \
+    batchrunner.cpp \
+    fitcache.cpp \
+    gradopt.cpp \
+    groupstats.cpp \
+    grubbs.cpp \
+    inpformat.cpp \
+    neldermead.cpp \
+    normaldist.cpp \
+    radixsort.cpp \
+    ranksum.cpp \
+    runcontrol.cpp \
+    shapirowilk.cpp \
+    streamingfit.cpp \
+    tukey.cpp \
+    weibullkernel.cpp
+
+HEADERS += \
+    AbstractMethod.h \
+    Method_Anova.h \
+    Method_FisherStudent.h \
+    Method_Grubbs.h \
+    Method_GrubbsESD.h \
+    Method_MLE_Normal.h \
+    Method_MLE_Weibull.h \
+    Method_MLE_Weibull3.h \
+    Method_MLS_Normal.h \
+    Method_MLS_Weibull.h \
+    Method_ShapiroWilk.h \
+    Method_Wilcoxon.h \
+    MethodRegistry.h \
+    analysis.h \
+    autodiff.h \
+    batchrunner.h \
+    binarysample.h \
+    bootstrap.h \
+    fitcache.h \
+    gradopt.h \
+    groupstats.h \
+    grubbs.h \
+    inpformat.h \
+    neldermead.h \
+    normaldist.h \
+    parallel.h \
+    radixsort.h \
+    ranksum.h \
+    runcontrol.h \
+    sampleview.h \
+    shapirowilk.h \
+    simdexp.h \
+    streamingfit.h \
+    tukey.h \
+    weibullkernel.h
+
+unix: LIBS += -lpthread
+
+# Путь к заголовочным файлам
+INCLUDEPATH += /opt/homebrew/Cellar/boost/1.89.0_1/include
+
+# Путь к скомпилированным библиотекам
+LIBS += -L/opt/homebrew/Cellar/boost/1.89.0_1/lib
@@ -11,24 +11,59 @@ CONFIG += c++17
 
 SOURCES += \
     analysis.cpp \
+    fitcache.cpp \
+    gradopt.cpp \
+    groupstats.cpp \
+    grubbs.cpp \
+    inpformat.cpp \
+    inputparser.cpp \
     main.cpp \
     mainwindow.cpp \
-    neldermead.cpp
+    neldermead.cpp \
+    normaldist.cpp \
+    plotlod.cpp \
+    radixsort.cpp \
+    ranksum.cpp \
+    runcontrol.cpp \
+    shapirowilk.cpp \
+    tukey.cpp \
+    weibullkernel.cpp
 
 HEADERS += \
     AbstractMethod.h \
     Method_Anova.h \
     Method_FisherStudent.h \
     Method_Grubbs.h \
+    Method_GrubbsESD.h \
     Method_MLE_Normal.h \
     Method_MLE_Weibull.h \
+    Method_MLE_Weibull3.h \
     Method_MLS_Normal.h \
     Method_MLS_Weibull.h \
     Method_ShapiroWilk.h \
     Method_Wilcoxon.h \
+    MethodRegistry.h \
     analysis.h \
+    autodiff.h \
+    fitcache.h \
+    gradopt.h \
+    groupstats.h \
+    grubbs.h \
+    inpformat.h \
+    inputparser.h \
     mainwindow.h \
-    neldermead.h
+    neldermead.h \
+    normaldist.h \
+    parallel.h \
+    plotlod.h \
+    radixsort.h \
+    ranksum.h \
+    runcontrol.h \
+    sampleview.h \
+    shapirowilk.h \
+    simdexp.h \
+    tukey.h \
+    weibullkernel.h
 
 FORMS += \
     mainwindow.ui
@@ -44,4 +79,4 @@ INCLUDEPATH += /opt/homebrew/Cellar/boost/1.89.0_1/include
 # Путь к скомпилированным библиотекам
 LIBS += -L/opt/homebrew/Cellar/boost/1.89.0_1/lib
 
-QT += charts
+QT += charts concurrent
@@ -0,0 +1,46 @@
+#ifndef METHODREGISTRY_H
+#define METHODREGISTRY_H
+
+#include "AbstractMethod.h"
+#include "Method_MLE_Normal.h"
+#include "Method_MLE_Weibull.h"
+#include "Method_MLE_Weibull3.h"
+#include "Method_MLS_Normal.h"
+#include "Method_MLS_Weibull.h"
+#include "Method_Grubbs.h"
+#include "Method_GrubbsESD.h"
+#include "Method_FisherStudent.h"
+#include "Method_Anova.h"
+#include "Method_ShapiroWilk.h"
+#include "Method_Wilcoxon.h"
+#include <vector>
+
+// Единый список методов: id - короткое имя для консоли и имен .inp файлов,
+// title - пункт дерева в MainWindow
+struct MethodInfo {
+    const char* id;
+    const char* title;
+    AbstractMethod* (*create)();
+};
+
+template <class M>
+AbstractMethod* createMethod() { return new M(); }
+
+inline const std::vector<MethodInfo>& methodRegistry() {
+    static const std::vector<MethodInfo> registry = {
+        {"MLE_Normal",    "Нормальное распределение",                     &createMethod<Method_MLE_Normal>},
+        {"MLE_Weibull",   "Распределение Вейбулла-Гнеденко",              &createMethod<Method_MLE_Weibull>},
+        {"MLE_Weibull3",  "Распределение Вейбулла-Гнеденко с порогом",    &createMethod<Method_MLE_Weibull3>},
+        {"MLS_Normal",    "Нормальное распределение MLS",                 &createMethod<Method_MLS_Normal>},
+        {"MLS_Weibull",   "Распределение Вейбулла-Гнеденко MLS",          &createMethod<Method_MLS_Weibull>},
+        {"Grubbs",        "Критерий Граббса",                             &createMethod<Method_Grubbs>},
+        {"GrubbsESD",     "Обобщенный критерий Граббса (ESD)",            &createMethod<Method_GrubbsESD>},
+        {"FisherStudent", "Критерий Фишера-Стьюдента",                    &createMethod<Method_FisherStudent>},
+        {"Anova",         "Однофакторный дисперсионный анализ (ANOVA)",   &createMethod<Method_Anova>},
+        {"ShapiroWilk",   "Критерий Шапило-Уилка (W-критерий)",           &createMethod<Method_ShapiroWilk>},
+        {"Wilcoxon",      "Двухвыборочный критерий Уилкоксона",           &createMethod<Method_Wilcoxon>},
+    };
+    return registry;
+}
+
+#endif
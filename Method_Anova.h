@@ -2,82 +2,54 @@
 #define METHOD_ANOVA_H
 
 #include "AbstractMethod.h"
+#include "groupstats.h"
 #include <vector>
 #include <cmath>
-#include <numeric>
 #include <QString>
-#include <iomanip>
 #include <boost/math/distributions/fisher_f.hpp>
 
 class Method_Anova : public AbstractMethod {
 public:
-    bool hasGraph() override { return false; }
+    bool hasGraph() const override { return false; }
 
-    QString calculate(const std::vector<double>& data, const std::vector<int>& cens) override {
+    MethodResult calculate(DataView data, CensView cens, bool withGraph) const override {
         Q_UNUSED(cens);
+        Q_UNUSED(withGraph);
+        MethodResult res;
+        res.report = buildReport(data);
+        return res;
+    }
 
+private:
+    QString buildReport(DataView data) const {
         if (data.empty()) return "Ошибка: Входные данные пусты";
 
         int k = static_cast<int>(data[0]);
         if (k < 2) return "Ошибка: Для ANOVA требуется минимум 2 группы";
 
-        struct Group {
-            std::vector<double> values;
-            double mean;
-            double var; // выборочная дисперсия (s^2)
-            int n;
-        };
-
-        std::vector<Group> groups;
+        // Группы не копируются: по каждой - сводка (n, среднее, сумма квадратов)
+        std::vector<Moments> groups;
         size_t currentIdx = 1;
-        int totalN = 0;
-        double sumAll = 0;
-
         for (int i = 0; i < k; ++i) {
             if (currentIdx >= data.size()) break;
-            int n_i = static_cast<int>(data[currentIdx++]);
-            Group g;
-            g.n = n_i;
-            totalN += n_i;
-
-            double groupSum = 0;
-            for (int j = 0; j < n_i; ++j) {
-                double val = data[currentIdx++];
-                g.values.push_back(val);
-                groupSum += val;
-            }
-            g.mean = groupSum / n_i;
-            sumAll += groupSum;
-
-            double sqDiffSum = 0;
-            for (double val : g.values) {
-                sqDiffSum += (val - g.mean) * (val - g.mean);
-            }
-            g.var = (n_i > 1) ? sqDiffSum / (n_i - 1) : 0;
-            groups.push_back(g);
+            size_t n_i = static_cast<size_t>(data[currentIdx++]);
+            if (n_i > data.size() - currentIdx) return "Ошибка: объем группы больше числа значений";
+            groups.push_back(moments_of(DataView(data.data() + currentIdx, n_i)));
+            currentIdx += n_i;
         }
 
-        // ANOVA
-        double generalMean = sumAll / totalN;
+        if (groups.size() != static_cast<size_t>(k)) return "Ошибка: групп в данных меньше k";
 
-        // Межгрупповая дисперсия (S_out)
-        double ssOut = 0;
-        for (const auto& g : groups) {
-            ssOut += g.n * (g.mean - generalMean) * (g.mean - generalMean);
-        }
+        OneWayAnova anova = one_way_anova(groups);
+        if (anova.classic.df2 < 1) return "Ошибка: наблюдений должно быть больше числа групп";
+        double generalMean = anova.grandMean;
         int df1 = k - 1;
-        double sOut = ssOut / df1;
-
-        // Внутригрупповая дисперсия (S_in)
-        double ssIn = 0;
-        for (const auto& g : groups) {
-            ssIn += (g.n - 1) * g.var;
-        }
-        int df2 = totalN - k;
-        double sIn = ssIn / df2;
+        double sOut = anova.ssBetween / df1;
+        int df2 = static_cast<int>(anova.classic.df2);
+        double sIn = anova.ssWithin / df2;
 
         // F-статистика
-        double f_obs = sOut / sIn;
+        double f_obs = anova.classic.f;
         double alpha = 0.05; // По умолчанию из твоего ТЗ
 
         boost::math::fisher_f_distribution<double> dist(df1, df2);
@@ -89,19 +61,28 @@ public:
         res += QString("Число групп (выборок) k = %1\n").arg(k);
         res += QString("Общая средняя X.. = %1\n\n").arg(generalMean, 0, 'f', 10);
 
-        for (int i = 0; i < groups.size(); ++i) {
+        for (size_t i = 0; i < groups.size(); ++i) {
             res += QString("Группа %1: n = %2, mean = %3, stdDev = %4\n")
                        .arg(i + 1)
-                       .arg(groups[i].n)
+                       .arg(static_cast<long long>(groups[i].n))
                        .arg(groups[i].mean, 0, 'f', 10)
-                       .arg(std::sqrt(groups[i].var), 0, 'f', 10);
+                       .arg(std::sqrt(groups[i].variance()), 0, 'f', 10);
         }
 
         res += QString("\nМежгрупповая дисперсия S_out = %1\n").arg(sOut, 0, 'f', 10);
         res += QString("Внутригрупповая дисперсия S_in  = %1\n").arg(sIn, 0, 'f', 10);
         res += QString("Наблюдаемое значение F = %1\n").arg(f_obs, 0, 'f', 10);
         res += QString("Степени свободы: f1 = %1, f2 = %2\n").arg(df1).arg(df2);
-        res += QString("Критическое значение F_(1-alpha) = %1\n\n").arg(f_crit, 0, 'f', 10);
+        res += QString("Критическое значение F_(1-alpha) = %1\n").arg(f_crit, 0, 'f', 10);
+        res += QString("p-значение = %1\n\n").arg(anova.classic.p, 0, 'g', 6);
+
+        // Без предположения о равенстве дисперсий групп
+        res += QString("Уэлч: F = %1, f1 = %2, f2 = %3, p = %4\n")
+                   .arg(anova.welch.f, 0, 'f', 10).arg(anova.welch.df1, 0, 'f', 0)
+                   .arg(anova.welch.df2, 0, 'f', 4).arg(anova.welch.p, 0, 'g', 6);
+        res += QString("Браун-Форсайт: F* = %1, f1 = %2, f2 = %3, p = %4\n\n")
+                   .arg(anova.brownForsythe.f, 0, 'f', 10).arg(anova.brownForsythe.df1, 0, 'f', 0)
+                   .arg(anova.brownForsythe.df2, 0, 'f', 4).arg(anova.brownForsythe.p, 0, 'g', 6);
 
         res += "Решение: ";
         if (f_obs <= f_crit) {
@@ -109,11 +90,33 @@ public:
         } else {
             res += "H0 отвергается (различия между средними статистически значимы).";
         }
+        res += "\n\n";
+        res += buildPostHoc(groups, alpha);
 
         return res;
     }
 
-    std::vector<GraphSeriesData> getGraphData() override { return {}; }
+    // Все пары групп: Тьюки (общая дисперсия) и Геймс-Хауэлл (дисперсии групп);
+    // * - среднее различается на уровне alpha
+    static QString buildPostHoc(const std::vector<Moments>& groups, double alpha) {
+        PostHoc ph = post_hoc(groups, alpha);
+        QString res = "Попарные сравнения (Тьюки HSD / Геймс-Хауэлл)\n";
+        res += QString("Критическое значение q_(1-alpha)(k, f2) = %1\n").arg(ph.qCrit, 0, 'f', 6);
+        res += "i-j ; разность ; q_T ; p_T ; интервал_T ; q_GH ; f_GH ; p_GH ; интервал_GH\n";
+        for (const PairComparison& pc : ph.pairs) {
+            res += QString("%1-%2 ; %3 ; %4 ; %5%6 ; [%7, %8] ; %9 ; ")
+                       .arg(pc.i + 1).arg(pc.j + 1)
+                       .arg(pc.diff, 0, 'f', 6).arg(pc.qTukey, 0, 'f', 4)
+                       .arg(pc.pTukey, 0, 'g', 4).arg(pc.pTukey < alpha ? "*" : "")
+                       .arg(pc.lowTukey, 0, 'f', 6).arg(pc.highTukey, 0, 'f', 6)
+                       .arg(pc.qGames, 0, 'f', 4);
+            res += QString("%1 ; %2%3 ; [%4, %5]\n")
+                       .arg(pc.dfGames, 0, 'f', 2)
+                       .arg(pc.pGames, 0, 'g', 4).arg(pc.pGames < alpha ? "*" : "")
+                       .arg(pc.lowGames, 0, 'f', 6).arg(pc.highGames, 0, 'f', 6);
+        }
+        return res;
+    }
 };
 
 #endif
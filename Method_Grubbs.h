@@ -2,21 +2,25 @@
 #define METHOD_GRUBBS_H
 
 #include "AbstractMethod.h"
+#include "grubbs.h"
 #include <vector>
-#include <algorithm>
-#include <cmath>
 #include <QString>
-#include <boost/math/distributions/students_t.hpp>
 
 class Method_Grubbs : public AbstractMethod {
 public:
 
-    bool hasGraph() override { return false; }
+    bool hasGraph() const override { return false; }
 
-    QString calculate(const std::vector<double>& data, const std::vector<int>& cens) override {
+    MethodResult calculate(DataView data, CensView cens, bool withGraph) const override {
         Q_UNUSED(cens);
+        Q_UNUSED(withGraph);
+        MethodResult res;
+        res.report = buildReport(data);
+        return res;
+    }
 
-
+private:
+    QString buildReport(DataView data) const {
         if (data.size() < 6) return "Ошибка: Недостаточно данных для формата Граббса";
 
         int n_val = static_cast<int>(data[0]);
@@ -30,28 +34,16 @@ public:
             sample.push_back(data[i]);
         }
 
-        double n = static_cast<double>(sample.size());
-        if (n < 3) return "Ошибка: выборка слишком мала";
-
-        double sum = 0;
-        for (double x : sample) sum += x;
-        double mean = sum / n;
-
-        double sq_sum = 0;
-        double minVal = sample[0];
-        double maxVal = sample[0];
-        for (double x : sample) {
-            sq_sum += (x - mean) * (x - mean);
-            if (x < minVal) minVal = x;
-            if (x > maxVal) maxVal = x;
-        }
-        double stdDev = std::sqrt(sq_sum / (n - 1.0));
-
-        double u_max = (maxVal - mean) / stdDev;
-        double u_min = (mean - minVal) / stdDev;
-        double u_obs = (state == 0) ? std::max(u_max, u_min) : (state == 1 ? u_max : u_min);
+        if (sample.size() < 3) return "Ошибка: выборка слишком мала";
 
-        double u_crit = calculateUCrit(sample.size(), alpha, (state != 0));
+        // Один шаг обобщенного критерия - классический критерий Граббса
+        GrubbsEsd esd = grubbs_esd(sample, 1, alpha, state);
+        if (esd.steps.empty()) return "Ошибка: все значения выборки совпадают";
+        const GrubbsStep& st = esd.steps.front();
+        double mean = st.mean;
+        double stdDev = st.stdDev;
+        double u_obs = st.statistic;
+        double u_crit = st.critical;
 
         QString res;
         res += "Критерий Граббса для нормального распределения\n";
@@ -84,24 +76,6 @@ public:
 
         return res;
     }
-
-
-    std::vector<GraphSeriesData> getGraphData() override {
-        return std::vector<GraphSeriesData>();
-    }
-
-
-
-private:
-    double calculateUCrit(int n, double alpha, bool oneSided) {
-        using namespace boost::math;
-        try {
-            students_t dist(n - 2);
-            double p = oneSided ? (alpha / n) : (alpha / (2.0 * n));
-            double t = quantile(complement(dist, p));
-            return ((n - 1.0) / std::sqrt(static_cast<double>(n))) * std::sqrt((t * t) / (n - 2.0 + t * t));
-        } catch (...) { return 0.0; }
-    }
 };
 
 #endif
@@ -0,0 +1,78 @@
+#ifndef METHOD_GRUBBSESD_H
+#define METHOD_GRUBBSESD_H
+
+#include "AbstractMethod.h"
+#include "grubbs.h"
+#include "runcontrol.h"
+#include <vector>
+#include <QString>
+
+// Обобщенный критерий Граббса (ESD) - до k выбросов.
+// Формат: n, state (0 - двусторонний, 1 - максимумы, 2 - минимумы), alpha, k, выборка
+class Method_GrubbsESD : public AbstractMethod {
+public:
+
+    bool hasGraph() const override { return false; }
+
+    MethodResult calculate(DataView data, CensView cens, bool withGraph) const override {
+        Q_UNUSED(cens);
+        Q_UNUSED(withGraph);
+        MethodResult res;
+        res.report = buildReport(data);
+        return res;
+    }
+
+private:
+    QString buildReport(DataView data) const {
+        if (data.size() < 7) return "Ошибка: Недостаточно данных для формата ESD";
+
+        int n_val = static_cast<int>(data[0]);
+        int state = static_cast<int>(data[1]);
+        double alpha = data[2];
+        int k = static_cast<int>(data[3]);
+        DataView sample(data.data() + 4, data.size() - 4);
+        if (sample.size() < 3) return "Ошибка: выборка слишком мала";
+        if (n_val != static_cast<int>(sample.size()))
+            return QString("Ошибка: n = %1 не совпадает с числом значений выборки (%2)").arg(n_val).arg(sample.size());
+        if (k < 1) return "Ошибка: k должно быть не меньше 1";
+
+        RunControl* control = currentRunControl();
+        GrubbsEsd esd = grubbs_esd(sample, k, alpha, state, control);
+        if (control && control->cancelled()) return "Ошибка: расчет отменен";
+        if (esd.steps.empty()) return "Ошибка: все значения выборки совпадают";
+
+        QString res;
+        res += "Обобщенный критерий Граббса (ESD) для нормального распределения\n";
+        res += "---------------------------------------------------------------\n";
+        res += QString("Размер выборки n      = %1\n").arg(sample.size());
+        res += QString("state                 = %1\n").arg(state);
+        res += QString("Уровень значимости α  = %1\n").arg(alpha, 0, 'f', 6);
+        res += QString("Наибольшее число выбросов k = %1\n\n").arg(k);
+
+        res += "i ; n_i ; x ; Среднее ; СКО ; R_i ; lambda_i\n";
+        for (size_t i = 0; i < esd.steps.size(); ++i) {
+            const GrubbsStep& st = esd.steps[i];
+            res += QString("%1 ; %2 ; %3 ; %4 ; %5 ; %6 ; %7\n")
+                       .arg(i + 1).arg(st.n)
+                       .arg(st.value, 0, 'f', 6).arg(st.mean, 0, 'f', 6).arg(st.stdDev, 0, 'f', 6)
+                       .arg(st.statistic, 0, 'f', 6).arg(st.critical, 0, 'f', 6);
+        }
+        if (esd.capped)
+            res += QString("k ограничено объемом: не больше n - 2 = %1 шагов\n").arg(sample.size() - 2);
+        if (esd.degenerate)
+            res += QString("Проверено шагов: %1 (остаток выборки вырожден, s = 0)\n").arg(esd.steps.size());
+
+        res += QString("\nЧисло выбросов = %1\n").arg(esd.outliers);
+        res += "Вывод: ";
+        if (esd.outliers == 0) {
+            res += "R_i <= lambda_i на всех шагах, выбросов нет.";
+        } else {
+            res += "выбросы:";
+            for (int i = 0; i < esd.outliers; ++i)
+                res += QString(" %1").arg(esd.steps[i].value, 0, 'f', 6);
+        }
+        return res;
+    }
+};
+
+#endif
@@ -3,33 +3,34 @@
 
 #include "AbstractMethod.h"
 #include "analysis.h"
+#include "fitcache.h"
+#include "normaldist.h"
 #include <cmath>
 #include <numeric>
 #include <algorithm>
 #include <QDateTime>
 
 class Method_MLE_Normal : public AbstractMethod {
-private:
-    double mu = 0;
-    double sigma = 1;
-    std::vector<double> lastData;
-    std::vector<int> lastCens;
-
 public:
-    bool hasGraph() override { return true; }
+    bool hasGraph() const override { return true; }
 
-    QString calculate(const std::vector<double>& data, const std::vector<int>& cens) override {
-        lastData = data;
-        lastCens = cens;
-        if (data.empty()) return "Error: No data";
+    MethodResult calculate(DataView data, CensView cens, bool withGraph) const override {
+        MethodResult res;
+        if (data.empty()) { res.report = "Error: No data"; return res; }
 
 
         int n = data.size();
-        double sum = std::accumulate(data.begin(), data.end(), 0.0);
-        mu = sum / n;
-        double sq_sum = 0;
-        for(double x : data) sq_sum += (x - mu) * (x - mu);
-        sigma = std::sqrt(sq_sum / n);
+        FitContext ctx(data, cens);
+        ctx.attachCache(fitCache().lookup(data, cens));
+        // Матрица ковариации (Cov[a, s]) по наблюдаемой информации; без
+        // цензуры совпадает с sigma^2/n, sigma^2/2n
+        FitRecord fit = ctx.memo("MLE_Normal", [&] {
+            auto est = normal_mle_2par(ctx);
+            auto cv = cov_normal_observed(ctx, est.first, est.second);
+            return FitRecord{{est.first, est.second}, cv.first, cv.second};
+        });
+        double mu = fit.params[0];
+        double sigma = fit.params[1];
 
 
         QString out;
@@ -44,15 +45,24 @@ public:
         for(int r : cens) out += QString::number(r) + " , ";
         out += "\n";
 
+        out += estimatesReport(res, n, mu, sigma, fit.cov);
+        res.report = out;
+
+        if (withGraph) res.graph = buildGraph(ctx, mu, sigma);
+        return res;
+    }
+
+    // Оценки, ковариация и таблица квантилей (часть отчета после X/R);
+    // используется и потоковым режимом, где выборка целиком не хранится
+    static QString estimatesReport(MethodResult& res, int n, double mu, double sigma,
+                                   const std::vector<std::vector<double>>& cov) {
+        QString out;
         out += QString("a_hat=%1\n").arg(mu, 0, 'f', 12);
         out += QString("sigma_hat=%1\n").arg(sigma, 0, 'f', 12);
 
-        // Матрица ковариации (Cov[a, s]) - примерные значения, подставь свой расчет
-        double var_a = (sigma * sigma) / n;
-        double var_s = (sigma * sigma) / (2.0 * n);
         out += "Cov[a,s]:\n";
-        out += QString("%1 %2\n").arg(var_a, 0, 'f', 12).arg(0.0, 0, 'f', 12);
-        out += QString("%1 %2\n").arg(0.0, 0, 'f', 12).arg(var_s, 0, 'f', 12);
+        out += QString("%1 %2\n").arg(cov[0][0], 0, 'f', 12).arg(cov[0][1], 0, 'f', 12);
+        out += QString("%1 %2\n").arg(cov[1][0], 0, 'f', 12).arg(cov[1][1], 0, 'f', 12);
 
         std::vector<double> probs = {0.005, 0.01, 0.025, 0.05, 0.1, 0.2, 0.3, 0.5, 0.7, 0.8, 0.9, 0.95, 0.975, 0.99, 0.995};
         out += "P\n";
@@ -66,32 +76,32 @@ public:
 
             // расчет доверительного интервала для квантили
             double se = (sigma / std::sqrt((double)n)) * std::sqrt(1.0 + 0.5 * zp * zp);
+            QuantileRow row{p, val - 1.96 * se, val, val + 1.96 * se};
+            res.quantiles.push_back(row);
 
-            xp_low += QString::number(val - 1.96 * se, 'f', 12) + " ; ";
-            xp_mid += QString::number(val, 'f', 12) + " ; ";
-            xp_up  += QString::number(val + 1.96 * se, 'f', 12) + " ; ";
+            xp_low += QString::number(row.low, 'f', 12) + " ; ";
+            xp_mid += QString::number(row.est, 'f', 12) + " ; ";
+            xp_up  += QString::number(row.up, 'f', 12) + " ; ";
         }
 
         out += "Xp_low\n" + xp_low + "\n";
         out += "Xp\n" + xp_mid + "\n";
         out += "Xp_up\n" + xp_up + "\n";
 
+        res.params = {mu, sigma};
+        res.cov = cov;
         return out;
     }
 
-    bool hasGraph() const { return true; }
-
-    std::vector<GraphSeriesData> getGraphData() override {
+private:
+    // Точки берутся в порядке, уже посчитанном в контексте для оценок
+    std::vector<GraphSeriesData> buildGraph(const FitContext& ctx, double mu, double sigma) const {
         std::vector<GraphSeriesData> res;
-        if (lastData.empty()) return res;
 
-        std::vector<std::pair<double, int>> pairedData;
-        for(size_t i = 0; i < lastData.size(); ++i) {
-            pairedData.push_back({lastData[i], lastCens[i]});
-        }
-        std::sort(pairedData.begin(), pairedData.end());
+        const size_t* order = ctx.sortedOrder();
+        auto at = [&](size_t i) { return order ? order[i] : i; };
 
-        size_t n = pairedData.size();
+        size_t n = ctx.x.size();
 
         //точки
         GraphSeriesData dots_normal;
@@ -102,12 +112,16 @@ public:
         dots_cens.name = "Censored";
         dots_cens.isScatter = true;
 
+        // Квантили всех точек одним пакетом
+        std::vector<double> pq(n), zq(n);
+        for(size_t i = 0; i < n; ++i) pq[i] = (i + 0.375) / (n + 0.25);
+        norm_ppf_batch(pq.data(), zq.data(), n);
+
         for(size_t i = 0; i < n; ++i) {
-            double p = (i + 0.375) / (n + 0.25);
-            double x_val = pairedData[i].first;
-            double y_val = 5.0 + norm_ppf(p);
+            double x_val = ctx.x[at(i)];
+            double y_val = 5.0 + zq[i];
 
-            if (pairedData[i].second == 0) {
+            if (ctx.r[at(i)] == 0) {
                 dots_normal.x.push_back(x_val);
                 dots_normal.y.push_back(y_val);
             } else {
@@ -125,8 +139,8 @@ public:
         ci_low.name = "CI_low"; // вспомогательное имя
         line.isScatter = ci_up.isScatter = ci_low.isScatter = false;
 
-        double x_start = pairedData.front().first;
-        double x_end = pairedData.back().first;
+        double x_start = ctx.x[at(0)];
+        double x_end = ctx.x[at(n - 1)];
         double step = (x_end - x_start) / 100.0;
 
         for(double x = x_start; x <= x_end + step/2.0; x += step) {
@@ -3,35 +3,32 @@
 
 #include "AbstractMethod.h"
 #include "analysis.h"
+#include "fitcache.h"
 #include <cmath>
 #include <numeric>
 #include <algorithm>
 #include <vector>
 
 class Method_MLE_Weibull : public AbstractMethod {
-private:
-    double c_hat = 0;
-    double b_hat = 1;
-    std::vector<double> lastData;
-    std::vector<int> lastCens;
-
 public:
-    bool hasGraph() override { return true; }
+    bool hasGraph() const override { return true; }
 
-    QString calculate(const std::vector<double>& data, const std::vector<int>& cens) override {
-        lastData = data;
-        lastCens = cens;
-        if (data.empty()) return "Error: No data";
+    MethodResult calculate(DataView data, CensView cens, bool withGraph) const override {
+        MethodResult res;
+        if (data.empty()) { res.report = "Error: No data"; return res; }
 
 
-        auto est = weibull_mle_2par(data, cens);
-        c_hat = est.first;
-        b_hat = est.second;
-
-        if (!(std::isfinite(c_hat) && std::isfinite(b_hat)) || c_hat <= 0.0 || b_hat <= 0.0) {
-            auto est_fb = weibull_regression_fallback(data, cens);
-            c_hat = est_fb.first; b_hat = est_fb.second;
-        }
+        FitContext ctx(data, cens);
+        ctx.attachCache(fitCache().lookup(data, cens));
+        FitRecord fit = ctx.memo("MLE_Weibull", [&] {
+            auto est = weibull_mle_2par(ctx);
+            if (!(std::isfinite(est.first) && std::isfinite(est.second)) || est.first <= 0.0 || est.second <= 0.0)
+                est = weibull_regression_fallback(ctx);
+            auto cv = cov_weibull_observed(ctx, est.first, est.second);
+            return FitRecord{{est.first, est.second}, cv.first, cv.second};
+        });
+        double c_hat = fit.params[0];
+        double b_hat = fit.params[1];
 
         int n = data.size();
         QString out;
@@ -46,14 +43,25 @@ public:
         for(int r : cens) out += QString::number(r) + " , ";
         out += "\n";
 
+        out += estimatesReport(res, n, c_hat, b_hat, fit.cov);
+        res.report = out;
+
+        if (withGraph) res.graph = buildGraph(ctx, c_hat, b_hat);
+        return res;
+    }
+
+    // Оценки, ковариация и таблица квантилей (часть отчета после X/R);
+    // используется и потоковым режимом, где выборка целиком не хранится
+    static QString estimatesReport(MethodResult& res, int n, double c_hat, double b_hat,
+                                   const std::vector<std::vector<double>>& cov) {
+        QString out;
         out += QString("c_hat=%1\n").arg(c_hat, 0, 'f', 12);
         out += QString("b_hat=%1\n").arg(b_hat, 0, 'f', 12);
 
         // Матрица ковариации
-        auto cv = cov_weibull_asymp_eff(data, cens, c_hat, b_hat);
         out += "Cov[c,b]:\n";
-        out += QString("%1 %2\n").arg(cv.first[0][0], 0, 'f', 12).arg(cv.first[0][1], 0, 'f', 12);
-        out += QString("%1 %2\n").arg(cv.first[1][0], 0, 'f', 12).arg(cv.first[1][1], 0, 'f', 12);
+        out += QString("%1 %2\n").arg(cov[0][0], 0, 'f', 12).arg(cov[0][1], 0, 'f', 12);
+        out += QString("%1 %2\n").arg(cov[1][0], 0, 'f', 12).arg(cov[1][1], 0, 'f', 12);
 
         // Блок P и расчет квантилей
         std::vector<double> probs = {0.005, 0.01, 0.025, 0.05, 0.1, 0.2, 0.3, 0.5, 0.7, 0.8, 0.9, 0.95, 0.975, 0.99, 0.995};
@@ -69,28 +77,32 @@ public:
             // SE для Вейбулла
             double z = tp;
             double se_y = (1.0 / b_hat) * std::sqrt((1.0 + 0.5 * z * z) / (double)n);
+            QuantileRow row{p, val * std::exp(-1.96 * se_y), val, val * std::exp(1.96 * se_y)};
+            res.quantiles.push_back(row);
 
-            xp_low += QString::number(val * std::exp(-1.96 * se_y), 'f', 12) + " ; ";
-            xp_mid += QString::number(val, 'f', 12) + " ; ";
-            xp_up  += QString::number(val * std::exp(1.96 * se_y), 'f', 12) + " ; ";
+            xp_low += QString::number(row.low, 'f', 12) + " ; ";
+            xp_mid += QString::number(row.est, 'f', 12) + " ; ";
+            xp_up  += QString::number(row.up, 'f', 12) + " ; ";
         }
 
         out += "Xp_low\n" + xp_low + "\n";
         out += "Xp\n" + xp_mid + "\n";
         out += "Xp_up\n" + xp_up + "\n";
 
+        res.params = {c_hat, b_hat};
+        res.cov = cov;
         return out;
     }
 
-    std::vector<GraphSeriesData> getGraphData() override {
+private:
+    // Точки берутся в порядке, уже посчитанном в контексте для оценок
+    std::vector<GraphSeriesData> buildGraph(const FitContext& ctx, double c_hat, double b_hat) const {
         std::vector<GraphSeriesData> res;
-        if (lastData.empty()) return res;
 
-        std::vector<std::pair<double, int>> pairedData;
-        for(size_t i = 0; i < lastData.size(); ++i) pairedData.push_back({lastData[i], lastCens[i]});
-        std::sort(pairedData.begin(), pairedData.end());
+        const size_t* order = ctx.sortedOrder();
+        auto at = [&](size_t i) { return order ? order[i] : i; };
 
-        size_t n = pairedData.size();
+        size_t n = ctx.x.size();
 
         //точки
         GraphSeriesData dots_ev, dots_cens;
@@ -99,11 +111,11 @@ public:
 
         for(size_t i = 0; i < n; ++i) {
             double p = (i + 0.3) / (n + 0.4); // Агамировское смещение
-            double x_val = pairedData[i].first;
+            double x_val = ctx.x[at(i)];
             // Спрямляющая ось Y для Вейбулла: 5 + ln(-ln(1-p))
             double y_val = 5.0 + std::log(-std::log(1.0 - p));
 
-            if (pairedData[i].second == 0) {
+            if (ctx.r[at(i)] == 0) {
                 dots_ev.x.push_back(x_val); dots_ev.y.push_back(y_val);
             } else {
                 dots_cens.x.push_back(x_val); dots_cens.y.push_back(y_val);
@@ -116,8 +128,8 @@ public:
         line.name = "MLE Линия"; ci_up.name = "95% CI"; ci_low.name = "CI_low";
         line.isScatter = ci_up.isScatter = ci_low.isScatter = false;
 
-        double x_start = pairedData.front().first;
-        double x_end = pairedData.back().first;
+        double x_start = ctx.x[at(0)];
+        double x_end = ctx.x[at(n - 1)];
         double step = (x_end - x_start) / 100.0;
 
         for(double x = x_start; x <= x_end + step/2.0; x += step) {
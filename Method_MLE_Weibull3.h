@@ -0,0 +1,110 @@
+#ifndef METHOD_MLE_WEIBULL3_H
+#define METHOD_MLE_WEIBULL3_H
+
+#include "AbstractMethod.h"
+#include "analysis.h"
+#include "fitcache.h"
+#include <cmath>
+#include <algorithm>
+#include <vector>
+
+// Вейбулл с порогом (периодом безотказной работы) g:
+// F(x) = 1 - exp(-((x - g)/c)^b), x > g
+class Method_MLE_Weibull3 : public AbstractMethod {
+public:
+    bool hasGraph() const override { return true; }
+
+    MethodResult calculate(DataView data, CensView cens, bool withGraph) const override {
+        MethodResult res;
+        if (data.empty()) { res.report = "Error: No data"; return res; }
+
+        FitContext ctx(data, cens);
+        ctx.attachCache(fitCache().lookup(data, cens));
+        FitRecord rec = ctx.memo("MLE_Weibull3", [&] {
+            int fails = static_cast<int>(ctx.weibullLogs().fails);
+            if (fails < 3) return FitRecord{{}, {}, fails};
+            Weibull3Fit f = weibull_mle_3par(ctx);
+            auto cv = cov_weibull3_observed(ctx, f.c, f.b, f.g);
+            return FitRecord{{f.c, f.b, f.g, f.logLik, f.logLik2, f.boundary ? 1.0 : 0.0}, cv.first, cv.second};
+        });
+        if (rec.params.empty()) { res.report = "Ошибка: для порога нужно не менее трех отказов"; return res; }
+        Weibull3Fit fit;
+        fit.c = rec.params[0]; fit.b = rec.params[1]; fit.g = rec.params[2];
+        fit.logLik = rec.params[3]; fit.logLik2 = rec.params[4]; fit.boundary = rec.params[5] != 0;
+
+        int n = data.size();
+        QString out;
+        out += "Method:MLE_Weibull3\n";
+        out += QString("n=%1\n").arg(n);
+        out += QString("c_hat=%1\n").arg(fit.c, 0, 'f', 12);
+        out += QString("b_hat=%1\n").arg(fit.b, 0, 'f', 12);
+        out += QString("g_hat=%1\n").arg(fit.g, 0, 'f', 12);
+        out += QString("lnL=%1\n").arg(fit.logLik, 0, 'f', 6);
+        // Отношение правдоподобия против модели без порога (g = 0)
+        out += QString("lnL_2par=%1\n").arg(fit.logLik2, 0, 'f', 6);
+        out += QString("LR=%1\n").arg(2.0 * (fit.logLik - fit.logLik2), 0, 'f', 6);
+        if (fit.boundary)
+            out += "Внимание: b < 1, правдоподобие растет при g -> min x, ОМП порога не существует\n";
+
+        if (rec.cov.empty()) {
+            out += "Cov[c,b,g]: не определена (b <= 2, нерегулярный случай)\n";
+        } else {
+            out += "Cov[c,b,g]:\n";
+            for (const auto& row : rec.cov)
+                out += QString("%1 %2 %3\n").arg(row[0], 0, 'f', 12).arg(row[1], 0, 'f', 12).arg(row[2], 0, 'f', 12);
+        }
+
+        std::vector<double> probs = {0.005, 0.01, 0.025, 0.05, 0.1, 0.2, 0.3, 0.5, 0.7, 0.8, 0.9, 0.95, 0.975, 0.99, 0.995};
+        QString p_line, xp_line;
+        for (double p : probs) {
+            double val = fit.g + fit.c * std::pow(-std::log(1.0 - p), 1.0 / fit.b);
+            res.quantiles.push_back(QuantileRow{p, val, val, val});
+            p_line += QString::number(p, 'f', 12) + " ; ";
+            xp_line += QString::number(val, 'f', 12) + " ; ";
+        }
+        out += "P\n" + p_line + "\n";
+        out += "Xp\n" + xp_line + "\n";
+
+        res.report = out;
+        res.params = {fit.c, fit.b, fit.g};
+        res.cov = rec.cov;
+        if (withGraph) res.graph = buildGraph(ctx, fit);
+        return res;
+    }
+
+private:
+    // Вероятностная бумага Вейбулла по x - g: прямая z = b ln((x - g)/c)
+    static std::vector<GraphSeriesData> buildGraph(const FitContext& ctx, const Weibull3Fit& fit) {
+        std::vector<GraphSeriesData> res;
+        const size_t* order = ctx.sortedOrder();
+        auto at = [&](size_t i) { return order ? order[i] : i; };
+        size_t n = ctx.x.size();
+
+        GraphSeriesData dots_ev, dots_cens, line;
+        dots_ev.name = "Events"; dots_ev.isScatter = true;
+        dots_cens.name = "Censored"; dots_cens.isScatter = true;
+        line.name = "MLE Линия";
+
+        for (size_t i = 0; i < n; ++i) {
+            double p = (i + 0.3) / (n + 0.4);
+            double y_val = 5.0 + std::log(-std::log(1.0 - p));
+            GraphSeriesData& dots = ctx.r[at(i)] == 0 ? dots_ev : dots_cens;
+            dots.x.push_back(ctx.x[at(i)]);
+            dots.y.push_back(y_val);
+        }
+
+        double x_start = ctx.x[at(0)];
+        double x_end = ctx.x[at(n - 1)];
+        for (int k = 0; k <= 100; ++k) {
+            double x = x_start + (x_end - x_start) * k / 100.0;
+            if (x <= fit.g) continue;
+            line.x.push_back(x);
+            line.y.push_back(5.0 + fit.b * std::log((x - fit.g) / fit.c));
+        }
+
+        res.push_back(dots_ev); res.push_back(dots_cens); res.push_back(line);
+        return res;
+    }
+};
+
+#endif
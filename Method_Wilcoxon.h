@@ -2,23 +2,36 @@
 #define METHOD_WILCOXON_H
 
 #include "AbstractMethod.h"
+#include "analysis.h"
+#include "radixsort.h"
+#include "ranksum.h"
 #include <vector>
 #include <cmath>
 #include <algorithm>
 #include <numeric>
 #include <QString>
-#include <boost/math/distributions/normal.hpp>
 
 class Method_Wilcoxon : public AbstractMethod {
 public:
-    bool hasGraph() override { return false; }
+    bool hasGraph() const override { return false; }
 
-    QString calculate(const std::vector<double>& data, const std::vector<int>& cens) override {
+    MethodResult calculate(DataView data, CensView cens, bool withGraph) const override {
         Q_UNUSED(cens);
+        Q_UNUSED(withGraph);
+        MethodResult res;
+        res.report = buildReport(data);
+        return res;
+    }
 
+private:
+    QString buildReport(DataView data) const {
         if (data.size() < 5) return "Ошибка: Недостаточно данных";
 
         double alpha = data[0];
+        // Объемы проверяются до приведения к int: отрицательный или
+        // огромный m1/n1 прошел бы проверку размера и вывел бы за границы
+        if (!(data[1] >= 1 && data[2] >= 1 && data[1] + data[2] <= static_cast<double>(data.size())))
+            return "Ошибка: Размер данных не соответствует заголовку";
         int m1 = static_cast<int>(data[1]);
         int n1 = static_cast<int>(data[2]);
 
@@ -39,35 +52,58 @@ public:
         auto stats1 = getStats(x);
         auto stats2 = getStats(y);
 
-        struct Item { double val; int group; };
-        std::vector<Item> united;
-        for (double val : x) united.push_back({val, 1});
-        for (double val : y) united.push_back({val, 2});
-
-        std::sort(united.begin(), united.end(), [](const Item& a, const Item& b) {
-            return a.val < b.val;
-        });
+        // Объединенный ряд; признак - принадлежность второй выборке
+        std::vector<double> united(x);
+        united.insert(united.end(), y.begin(), y.end());
+        std::vector<int> inY(united.size(), 0);
+        std::fill(inY.begin() + m1, inY.end(), 1);
+        std::vector<size_t> order;
+        radix_sort_order(united, inY, order);
 
         int m_small = (m1 <= n1) ? m1 : n1;
         int small_group = (m1 <= n1) ? 1 : 2;
         double W_obs = 0;
 
-        for (size_t i = 0; i < united.size(); ++i) {
-            if (united[i].group == small_group) {
-                W_obs += (i + 1);
-            }
+        // Совпадающим значениям - средний ранг; размеры групп нужны точному счету
+        std::vector<int> ties;
+        for (size_t i = 0; i < united.size();) {
+            size_t j = i;
+            while (j < united.size() && united[order[j]] == united[order[i]]) ++j;
+            double midrank = (i + 1 + j) / 2.0;
+            for (size_t k = i; k < j; ++k)
+                if ((inY[order[k]] ? 2 : 1) == small_group) W_obs += midrank;
+            ties.push_back(static_cast<int>(j - i));
+            i = j;
+        }
+        int tiedGroups = 0;
+        for (int t : ties) if (t > 1) ++tiedGroups;
+        bool hasTies = tiedGroups > 0;
+
+
+        bool useExact = rank_sum_exact_feasible(m1, n1, ties);
+
+        double W_low, W_up, pValue;
+        if (useExact) {
+            // Точный счет до секунды и дольше - с отменой и прогрессом окна
+            RunControl* control = currentRunControl();
+            auto dist = hasTies ? rank_sum_exact_ties(m_small, ties, control)
+                                : rank_sum_exact(m_small, m1 + n1 - m_small, control);
+            if (!dist) return "Ошибка: расчет отменен";
+            W_low = dist->lowerCritical(alpha / 2.0);
+            W_up = dist->upperCritical(alpha / 2.0);
+            pValue = dist->pValue(W_obs);
+        } else {
+            int N = m1 + n1;
+            double tieSum = 0;
+            for (int t : ties) tieSum += static_cast<double>(t) * t * t - t;
+            double mu_w = (static_cast<double>(m_small) * (N + 1)) / 2.0;
+            double sigma_w = std::sqrt(static_cast<double>(m1) * n1 / 12.0 * ((N + 1) - tieSum / (static_cast<double>(N) * (N - 1))));
+            double z = norm_ppf(1.0 - alpha / 2.0);
+
+            W_low = std::round(mu_w - z * sigma_w);
+            W_up = std::round(mu_w + z * sigma_w);
+            pValue = std::min(1.0, 2.0 * norm_cdf(-std::abs(W_obs - mu_w) / sigma_w));
         }
-
-
-        bool useExact = (m1 + n1 <= 40);
-
-        double mu_w = (static_cast<double>(m_small) * (m1 + n1 + 1)) / 2.0;
-        double sigma_w = std::sqrt(static_cast<double>(m1 * n1 * (m1 + n1 + 1)) / 12.0);
-        boost::math::normal_distribution<double> dist(0.0, 1.0);
-        double z = boost::math::quantile(dist, 1.0 - alpha / 2.0);
-
-        double W_low = std::round(mu_w - z * sigma_w);
-        double W_up = std::round(mu_w + z * sigma_w);
 
 
         QString res = "================ Двусторонний критерий Уилкоксона ================\n\n";
@@ -80,7 +116,9 @@ public:
 
         res += QString("W_obs (сумма рангов) = %1\n").arg(W_obs);
         res += QString("Режим вычисления: %1\n").arg(useExact ? "ТОЧНЫЙ" : "ПРИБЛИЖЕННЫЙ");
-        res += QString("Критический интервал: [%1; %2]\n\n").arg(W_low).arg(W_up);
+        if (hasTies) res += QString("Совпадающих значений: групп %1, средние ранги\n").arg(tiedGroups);
+        res += QString("Критический интервал: [%1; %2]\n").arg(W_low).arg(W_up);
+        res += QString("p-value = %1\n\n").arg(pValue, 0, 'g', 6);
 
         res += "H0: распределения совпадают\nH1: распределения различаются\n\n";
 
@@ -92,8 +130,6 @@ public:
 
         return res;
     }
-
-    std::vector<GraphSeriesData> getGraphData() override { return {}; }
 };
 
 #endif
@@ -1,53 +1,200 @@
 #include "analysis.h"
-#include <boost/math/distributions/normal.hpp>
+#include "autodiff.h"
+#include "fitcache.h"
+#include "inpformat.h"
+#include "normaldist.h"
+#include "parallel.h"
+#include "radixsort.h"
+#include "weibullkernel.h"
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <numeric>
 #include <fstream>
 #include <iostream>
 
-OptData globalOptData;
-const std::vector<double>* G_X = nullptr;
-const std::vector<int>* G_R = nullptr;
-
 double norm_pdf(double z) {
     return 0.3989422804014327 * std::exp(-0.5 * z * z);
 }
 
+// Та же формула, что в boost::math::cdf(normal), без построения распределения
 double norm_cdf(double z) {
-    boost::math::normal_distribution<> N(0.0, 1.0);
-    return boost::math::cdf(N, z);
+    return 0.5 * std::erfc(-z / 1.41421356237309504880);
 }
 
 double norm_ppf(double p) {
     if (p <= 0.0) p = 1e-15;
     if (p >= 1.0) p = 1.0 - 1e-15;
-    boost::math::normal_distribution<> N(0.0, 1.0);
-    return boost::math::quantile(N, p);
+    return norm_ppf_as241(p);
 }
 
-EmpiricalKM kaplan_meier_Itype(const std::vector<double>& x, const std::vector<int>& r) {
-    int n = static_cast<int>(x.size());
-    if (n == 0) return {};
-    std::vector<std::pair<double, int>> data(n);
-    for(int i=0; i<n; ++i) data[i] = {x[i], r[i]};
-    std::sort(data.begin(), data.end());
+void km_sort_order(DataView x, CensView r, std::vector<size_t>& order) {
+    // Ключ (x, r != 0): при равных x отказы раньше цензуры, как на графиках
+    auto less = [&](size_t a, size_t b) {
+        return x[a] < x[b] || (x[a] == x[b] && r[a] == 0 && r[b] != 0);
+    };
+    order.clear();
+    const size_t n = x.size();
+    size_t i = 1;
+    while (i < n && !less(i, i - 1)) ++i;
+    if (i >= n) return;
+
+    // Поразрядная сортировка: признак цензуры - младший разряд ключа
+    radix_sort_order(x, r, order);
+}
 
+template <class Index>
+static EmpiricalKM kmPass(DataView x, CensView r, Index idx) {
+    const size_t n = x.size();
     EmpiricalKM res;
     double S = 1.0;
-    for (int i = 0; i < n; ++i) {
-        double n_at_risk = static_cast<double>(n - i);
-        if (data[i].second == 0) { // 0 - ОТКАЗ
-            S *= (1.0 - 1.0 / n_at_risk);
-            res.x_sorted.push_back(data[i].first);
+    size_t at_risk = n;
+    for (size_t i = 0; i < n;) {
+        const double xi = x[idx(i)];
+        size_t d = 0, j = i;
+        for (; j < n && x[idx(j)] == xi; ++j)
+            if (r[idx(j)] == 0) ++d; // 0 - ОТКАЗ
+        if (d > 0) {
+            S *= static_cast<double>(at_risk - d) / static_cast<double>(at_risk);
+            res.x_sorted.push_back(xi);
             res.F_emp.push_back(1.0 - S);
         }
+        at_risk -= j - i;
+        i = j;
     }
     return res;
 }
 
+EmpiricalKM kaplan_meier_sorted(DataView x, CensView r, const size_t* order) {
+    if (order) return kmPass(x, r, [order](size_t i) { return order[i]; });
+    return kmPass(x, r, [](size_t i) { return i; });
+}
+
+EmpiricalKM kaplan_meier_Itype(DataView x, CensView r) {
+    if (x.empty()) return {};
+    std::vector<size_t> order;
+    km_sort_order(x, r, order);
+    return kaplan_meier_sorted(x, r, order.empty() ? nullptr : order.data());
+}
+
+void FitContext::reset(DataView x_, CensView r_) {
+    x = x_;
+    r = r_;
+    shared.reset();
+    orderReady = kmReady = logsReady = normalReady = false;
+}
+
+void FitContext::attachCache(std::shared_ptr<SampleCache> cache) {
+    shared = std::move(cache);
+}
+
+FitRecord FitContext::memo(const std::string& key, const std::function<FitRecord()>& compute) const {
+    FitRecord rec;
+    if (shared && shared->find(key, rec)) return rec;
+    // Считается без блокировки: параллельные методы не ждут друг друга.
+    // Оценка отмененного расчета недосчитана и не запоминается.
+    rec = compute();
+    if (shared && !stopRequested()) shared->store(key, rec);
+    return rec;
+}
+
+const size_t* FitContext::sortedOrder() const {
+    if (shared) {
+        const std::vector<size_t>& o = shared->sortedOrder(x, r);
+        return o.empty() ? nullptr : o.data();
+    }
+    if (!orderReady) {
+        km_sort_order(x, r, order);
+        orderReady = true;
+    }
+    return order.empty() ? nullptr : order.data();
+}
+
+const EmpiricalKM& FitContext::km() const {
+    if (shared) return shared->km(x, r);
+    if (!kmReady) {
+        kmCache = kaplan_meier_sorted(x, r, sortedOrder());
+        kmReady = true;
+    }
+    return kmCache;
+}
+
+const WeibullLogs& FitContext::weibullLogs() const {
+    if (logsReady) return logs;
+    // Буфер d переиспользуется между выборками (бутстреп)
+    logs.d.clear();
+    logs.lmax = -HUGE_VAL;
+    logs.fails = 0;
+    double meanL = 0, M2 = 0;
+    for (size_t i = 0; i < x.size(); ++i) {
+        if (x[i] <= 0) continue;
+        double l = std::log(x[i]);
+        logs.d.push_back(l);
+        logs.lmax = std::max(logs.lmax, l);
+        if (r[i] != 0) continue;
+        ++logs.fails;
+        double delta = l - meanL;
+        meanL += delta / static_cast<double>(logs.fails);
+        M2 += delta * (l - meanL);
+    }
+    for (double& l : logs.d) l -= logs.lmax;
+    logs.failSum = static_cast<double>(logs.fails) * (meanL - logs.lmax);
+    logs.failVar = logs.fails ? M2 / static_cast<double>(logs.fails) : 0.0;
+    logsReady = true;
+    return logs;
+}
+
+// v при keep, иначе +0.0: маской по битам, без перехода и без умножения
+// (0 * inf дало бы NaN), поэтому сумма та же, что с условием
+static inline double keepIf(bool keep, double v) {
+    uint64_t b;
+    std::memcpy(&b, &v, sizeof(b));
+    b &= -static_cast<uint64_t>(keep);
+    std::memcpy(&v, &b, sizeof(v));
+    return v;
+}
+
+const NormalParts& FitContext::normalParts() const {
+    if (normalReady) return normal;
+    // Два прохода без делений в цикле, как в прежнем расчете среднего и СКО.
+    // Без ветвлений по r: при случайной цензуре переход угадывается через раз,
+    // и на 10^6 значений промахи стоили впятеро больше самих сумм.
+    // Цензурированные пишутся подряд с шагом (r != 0); последняя запись может
+    // попасть на запасной элемент, он отрезается.
+    const size_t n = x.size();
+    double sum = 0, sumF = 0;
+    size_t nf = 0;
+    for (size_t i = 0; i < n; ++i) {
+        sum += x[i];
+        sumF += keepIf(r[i] == 0, x[i]);
+        nf += r[i] == 0;
+    }
+    normal.surv.resize(n - nf + 1);
+    double* surv = normal.surv.data();
+    for (size_t i = 0, k = 0; i < n && nf < n; ++i) {
+        surv[k] = x[i];
+        k += r[i] != 0;
+    }
+    normal.surv.pop_back();
+    normal.mean = n ? sum / n : 0.0;
+    normal.fail.r = static_cast<double>(nf);
+    normal.fail.mean = nf ? sumF / nf : 0.0;
+    double sq = 0, sqF = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const double d = x[i] - normal.mean;
+        const double e = x[i] - normal.fail.mean;
+        sq += d * d;
+        sqF += keepIf(r[i] == 0, e * e);
+    }
+    normal.sd = n ? std::sqrt(sq / n) : 0.0;
+    normal.fail.M2 = sqF;
+    normalReady = true;
+    return normal;
+}
+
 // РЕГРЕССИОННЫЙ ФОЛБЭК ДЛЯ ВЕЙБУЛЛА
-std::pair<double, double> weibull_regression_fallback(const std::vector<double>& x, const std::vector<int>& r) {
-    auto emp = kaplan_meier_Itype(x, r);
+std::pair<double, double> weibull_regression_fallback(const FitContext& ctx) {
+    const EmpiricalKM& emp = ctx.km();
     std::vector<double> X_log, Y_log;
     for (size_t i = 0; i < emp.x_sorted.size(); ++i) {
         double F = emp.F_emp[i];
@@ -67,31 +214,231 @@ std::pair<double, double> weibull_regression_fallback(const std::vector<double>&
     return { std::exp(-a/b), b };
 }
 
-std::pair<double, double> weibull_mle_2par(const std::vector<double>& x, const std::vector<int>& r) {
-    std::vector<double> obs;
-    for(size_t i=0; i<x.size(); ++i) if(r[i] == 0) obs.push_back(x[i]);
-    if(obs.size() < 2) return weibull_regression_fallback(x, r);
+// ОМП ВЕЙБУЛЛА С ЦЕНЗУРОЙ
+// ln L = r ln b - r b ln c + (b - 1) sum_F ln x - sum_all (x/c)^b.
+// При фиксированном b максимум по c в явном виде: c^b = sum_all x^b / r,
+// остается профильное уравнение по форме
+//   g(b) = r/b + sum_F d - r S1/S0 = 0,  S_k - суммы weibull_sums по всем наблюдениям.
+// g убывает (неравенство Коши-Буняковского), поэтому корень единственный:
+// Ньютон с поддержкой вилки [lo, hi], шаг вне вилки заменяется делением пополам.
+std::pair<double, double> weibull_mle_2par(const FitContext& ctx, double b_start) {
+    const WeibullLogs& lg = ctx.weibullLogs();
+    if(lg.fails < 2) return weibull_regression_fallback(ctx);
 
-    double b = weibull_regression_fallback(x, r).second;
-    for(int it=0; it<100; ++it) {
-        double S0=0, S1=0, S2=0, L=0;
-        for(double v : obs) {
-            double lv = std::log(v), vb = std::pow(v, b);
-            S0 += vb; S1 += vb*lv; S2 += vb*lv*lv; L += lv;
-        }
-        double f = (L/obs.size()) - (S1/S0) + 1.0/b;
-        double df = -(S2*S0 - S1*S1)/(S0*S0) - 1.0/(b*b);
-        double step = f/df;
+    const double r = static_cast<double>(lg.fails);
+    const double* d = lg.d.data();
+    const size_t n = lg.d.size();
+
+    // Старт без сортировки: Var(ln X) = pi^2 / (6 b^2) по отказам
+    double b = b_start > 0 ? b_start
+             : (lg.failVar > 0 ? 3.14159265358979323846 / std::sqrt(6.0 * lg.failVar) : 1.0);
+    double lo = 0, hi = HUGE_VAL;
+    for(int it=0; it<100 && !ctx.stopRequested(); ++it) {
+        WeibullSums s = weibull_sums(d, n, b);
+        double g = r/b + lg.failSum - r*s.S1/s.S0;
+        double dg = -r/(b*b) - r*(s.S2*s.S0 - s.S1*s.S1)/(s.S0*s.S0);
+        if(g > 0) lo = b; else hi = b;
+
+        double step = g/dg;
+        if(std::abs(step) < 1e-10*b) { b -= step; break; }
         b -= step;
-        if(std::abs(step) < 1e-7) break;
+        if(!(b > lo && b < hi)) b = std::isfinite(hi) ? 0.5*(lo + hi) : 2.0*lo;
+    }
+    double s0 = weibull_sums(d, n, b).S0;
+    return { std::exp(lg.lmax) * std::pow(s0/r, 1.0/b), b };
+}
+
+// ОМП НОРМАЛЬНОГО ЗАКОНА С ЦЕНЗУРОЙ
+// ln L = -r ln sigma - sum_F z^2/2 + sum_S ln Q(z),  z = (x - mu)/sigma.
+// Отказы сворачиваются в (r, среднее, M2), поэтому итерация Ньютона - один
+// проход только по цензурированным.
+namespace {
+struct NormalLik {
+    double l, gm, gs;      // ln L и градиент по (mu, sigma)
+    double Hmm, Hms, Hss;  // гессиан
+};
+
+NormalLik normalLik(const NormalFailMoments& f, const NormalSurvSums& s, double mu, double sigma) {
+    const double dm = f.mean - mu, s2 = sigma * sigma;
+    const double Sz = f.r * dm / sigma;                  // sum_F z
+    const double Szz = (f.M2 + f.r * dm * dm) / s2;      // sum_F z^2
+    NormalLik e;
+    e.l = -f.r * std::log(sigma) - 0.5 * Szz + s.lnQ;
+    e.gm = (Sz + s.h) / sigma;
+    e.gs = (Szz - f.r + s.hz) / sigma;
+    e.Hmm = (-f.r - s.w) / s2;
+    e.Hms = (-2.0 * Sz - s.h - s.wz) / s2;
+    e.Hss = (f.r - 3.0 * Szz - 2.0 * s.hz - s.wzz) / s2;
+    return e;
+}
+}
+
+void normal_surv_sums(const double* xs, size_t m, double mu, double sigma, NormalSurvSums& acc, bool withLnQ) {
+    // Блоками: Q(z) и ф(z) пакетно (norm_sf_pdf_batch), остальное - плотным циклом
+    const size_t kBlock = 256;
+    double z[kBlock], Q[kBlock], pdf[kBlock];
+    const double inv = 1.0 / sigma;
+    for (size_t b = 0; b < m; b += kBlock) {
+        const size_t len = std::min(kBlock, m - b);
+        for (size_t i = 0; i < len; ++i) z[i] = (xs[b + i] - mu) * inv;
+        norm_sf_pdf_batch(z, Q, pdf, len);
+        for (size_t i = 0; i < len; ++i) {
+            double lnQ = 0, h;
+            if (z[i] < 35.0) {
+                // Логарифм - половина стоимости прохода, шагу Ньютона он не нужен
+                if (withLnQ) lnQ = std::log(Q[i]);
+                h = pdf[i] / Q[i];
+            } else {
+                // Асимптотика Миллса: Q(z) ~ ф(z)/z, h ~ z + 1/z
+                lnQ = -0.5 * z[i] * z[i] - std::log(z[i]) - 0.91893853320467274178;
+                h = z[i] + 1.0 / z[i];
+            }
+            const double w = h * (h - z[i]);
+            if (withLnQ) acc.lnQ += lnQ;
+            acc.h += h;
+            acc.hz += h * z[i];
+            acc.w += w;
+            acc.wz += w * z[i];
+            acc.wzz += w * z[i] * z[i];
+        }
+    }
+}
+
+std::pair<double, double> normal_mle_censored(const NormalFailMoments& f, double mu0, double sigma0,
+                                              const std::function<NormalSurvSums(double, double)>& surv,
+                                              const RunControl* control) {
+    double mu = mu0, sigma = sigma0;
+    NormalLik e = normalLik(f, surv(mu, sigma), mu, sigma);
+    for (int it = 0; it < 100; ++it) {
+        if (control && control->cancelled()) break;
+        // Шаг Ньютона; если гессиан не отрицательно определен - градиент,
+        // масштабированный ожидаемой информацией полной выборки
+        double dm, ds;
+        const double det = e.Hmm * e.Hss - e.Hms * e.Hms;
+        if (e.Hmm < 0 && det > 0) {
+            dm = -(e.Hss * e.gm - e.Hms * e.gs) / det;
+            ds = -(e.Hmm * e.gs - e.Hms * e.gm) / det;
+        } else {
+            dm = e.gm * sigma * sigma / f.r;
+            ds = e.gs * sigma * sigma / (2.0 * f.r);
+        }
+
+        // Дробление шага, пока правдоподобие не перестанет убывать
+        double t = 1.0;
+        bool accepted = false;
+        NormalLik en;
+        for (int k = 0; k < 40; ++k) {
+            const double sn = sigma + t * ds;
+            if (sn > 0) {
+                en = normalLik(f, surv(mu + t * dm, sn), mu + t * dm, sn);
+                if (en.l >= e.l - 1e-12 * (1.0 + std::abs(e.l))) { accepted = true; break; }
+            }
+            t *= 0.5;
+        }
+        if (!accepted) break;
+        mu += t * dm;
+        sigma += t * ds;
+        e = en;
+        // Сходимость квадратичная: после шага ~1e-6 остаток ~1e-12, и
+        // последний шаг делается без лишнего прохода
+        const double det2 = e.Hmm * e.Hss - e.Hms * e.Hms;
+        if (e.Hmm < 0 && det2 > 0) {
+            const double dm2 = -(e.Hss * e.gm - e.Hms * e.gs) / det2;
+            const double ds2 = -(e.Hmm * e.gs - e.Hms * e.gm) / det2;
+            if (std::abs(dm2) < 1e-6 * sigma && std::abs(ds2) < 1e-6 * sigma) {
+                mu += dm2;
+                sigma += ds2;
+                break;
+            }
+        }
+    }
+    return { mu, sigma };
+}
+
+std::vector<std::vector<double>> normal_observed_cov(const NormalFailMoments& f, const NormalSurvSums& s,
+                                                     double mu, double sigma) {
+    NormalLik e = normalLik(f, s, mu, sigma);
+    double Jmm = -e.Hmm, Jms = -e.Hms, Jss = -e.Hss;
+    double det = (Jmm*Jss - Jms*Jms);
+    if(!(std::abs(det) >= 1e-300)) det = 1e-300;
+    return {
+        {Jss/det, -Jms/det},
+        {-Jms/det, Jmm/det}
+    };
+}
+
+std::pair<double, double> normal_mle_2par(const FitContext& ctx) {
+    const NormalParts& np = ctx.normalParts();
+    if (np.surv.empty() || np.fail.r < 2) return { np.mean, np.sd };
+
+    // Большая цензурированная часть: сначала сходимость по прореженной
+    // выборке (каждое k-е значение с весом k), затем чистые шаги Ньютона по
+    // всей - без поиска вдоль направления и без ln Q, проход вдвое дешевле.
+    // Старт отстоит на ~1e-3 sigma, ошибка после шага ~ квадрат шага, поэтому
+    // обычно хватает двух проходов. Если гессиан не отрицательно определен
+    // или шаг не уменьшается - прежний Ньютон с дроблением от текущей точки.
+    double mu0 = np.mean, sigma0 = np.sd;
+    const size_t m = np.surv.size(), kSub = 16384;
+    if (m > 4 * kSub) {
+        const size_t k = m / kSub;
+        std::vector<double> sub;
+        sub.reserve(m / k + 1);
+        for (size_t i = 0; i < m; i += k) sub.push_back(np.surv[i]);
+        const double wgt = static_cast<double>(m) / sub.size();
+        auto start = normal_mle_censored(np.fail, mu0, sigma0, [&sub, wgt](double mu, double sigma) {
+            NormalSurvSums a;
+            normal_surv_sums(sub.data(), sub.size(), mu, sigma, a);
+            a.lnQ *= wgt; a.h *= wgt; a.hz *= wgt; a.w *= wgt; a.wz *= wgt; a.wzz *= wgt;
+            return a;
+        }, ctx.control);
+        if (std::isfinite(start.first) && std::isfinite(start.second) && start.second > 0) {
+            double mu = start.first, sigma = start.second, prev = HUGE_VAL;
+            for (int it = 0; it < 6 && !ctx.stopRequested(); ++it) {
+                NormalSurvSums acc;
+                normal_surv_sums(np.surv.data(), m, mu, sigma, acc, false);
+                const NormalLik e = normalLik(np.fail, acc, mu, sigma);
+                const double det = e.Hmm * e.Hss - e.Hms * e.Hms;
+                if (!(e.Hmm < 0 && det > 0)) break;
+                const double dm = -(e.Hss * e.gm - e.Hms * e.gs) / det;
+                const double ds = -(e.Hmm * e.gs - e.Hms * e.gm) / det;
+                const double step = std::max(std::abs(dm), std::abs(ds)) / sigma;
+                if (!(step < 0.5 * prev) || !(sigma + ds > 0)) break;
+                mu += dm;
+                sigma += ds;
+                // Остаток ~ step^2 < 1e-10 относительно sigma
+                if (step < 1e-5) return { mu, sigma };
+                prev = step;
+            }
+            mu0 = mu;
+            sigma0 = sigma;
+        }
+    }
+
+    auto est = normal_mle_censored(np.fail, mu0, sigma0, [&np](double mu, double sigma) {
+        NormalSurvSums acc;
+        normal_surv_sums(np.surv.data(), np.surv.size(), mu, sigma, acc);
+        return acc;
+    }, ctx.control);
+    if (!(std::isfinite(est.first) && std::isfinite(est.second) && est.second > 0)) return { np.mean, np.sd };
+    return est;
+}
+
+std::pair<std::vector<std::vector<double>>, int> cov_normal_observed(const FitContext& ctx, double mu, double sigma) {
+    const NormalParts& np = ctx.normalParts();
+    const int fails = static_cast<int>(np.fail.r);
+    if (fails < 2) {
+        const double n = static_cast<double>(std::max<size_t>(ctx.x.size(), 1));
+        return {{{sigma*sigma/n, 0.0}, {0.0, sigma*sigma/(2.0*n)}}, fails};
     }
-    double s0 = 0;
-    for(double v : obs) s0 += std::pow(v, b);
-    return { std::pow(s0/obs.size(), 1.0/b), b };
+    NormalSurvSums acc;
+    normal_surv_sums(np.surv.data(), np.surv.size(), mu, sigma, acc);
+    return {normal_observed_cov(np.fail, acc, mu, sigma), fails};
 }
 
 // КОВАРИАЦИЯ ВЕЙБУЛЛА
-std::pair<std::vector<std::vector<double>>, int> cov_weibull_asymp_eff(const std::vector<double>& x, const std::vector<int>& r, double c, double b) {
+std::pair<std::vector<std::vector<double>>, int> cov_weibull_asymp_eff(const FitContext& ctx, double c, double b) {
+    DataView x = ctx.x;
+    CensView r = ctx.r;
     int n_eff = 0;
     for (int ri : r) if (ri == 0) n_eff++;
     if (n_eff < 2) return {{{1,0},{0,1}}, n_eff};
@@ -111,23 +458,234 @@ std::pair<std::vector<std::vector<double>>, int> cov_weibull_asymp_eff(const std
     return {V, n_eff};
 }
 
-Sample read_input_normal(const std::string& tag) {
-    std::ifstream in("Inp/" + tag + ".inp");
-    Sample S; std::string tmp;
-    if (!in) return S;
-    in >> tmp >> S.n;
-    while(in >> tmp && tmp != "X" && tmp != "Data");
-    for(int i=0; i<S.n; ++i) {
-        std::string val; in >> val;
-        if(val == ",") { i--; continue; }
-        try { S.x.push_back(std::stod(val)); } catch(...) {}
-    }
-    while(in >> tmp && (tmp != "R" && tmp != "Censorizes"));
-    for(int i=0; i<S.n; ++i) {
-        std::string val; in >> val;
-        if(val == ",") { i--; continue; }
-        try { S.r.push_back(std::stoi(val)); } catch(...) {}
+// НАБЛЮДАЕМАЯ ИНФОРМАЦИЯ ВЕЙБУЛЛА
+// Параметры p = ln c, q = 1/b, z_i = (ln x_i - p)/q:
+//   ln L = sum_F (z_i - ln q) - sum_all e^{z_i}.
+// Через суммы ядра при d_i = ln x_i - lmax, delta = p - lmax, K = e^{-b delta}:
+//   A0 = sum e^z = K S0,  A1 = sum e^z z = K b (S1 - delta S0),
+//   A2 = sum e^z z^2 = K b^2 (S2 - 2 delta S1 + delta^2 S0),  Fz = sum_F z = b (L - r delta).
+// Гессиан (умноженный на q^2): Hpp = -A0, Hpq = r - A0 - A1, Hqq = r + 2 Fz - A2 - 2 A1.
+std::vector<std::vector<double>> weibull_observed_cov(const WeibullSums& s, double L, double r, double lmax,
+                                                      double c, double b) {
+    const double q = 1.0/b, delta = std::log(c) - lmax, K = std::exp(-b*delta);
+    const double A0 = K * s.S0;
+    const double A1 = K * b * (s.S1 - delta*s.S0);
+    const double A2 = K * b*b * (s.S2 - 2.0*delta*s.S1 + delta*delta*s.S0);
+    const double Fz = b * (L - r*delta);
+
+    double Jpp = A0, Jpq = A0 + A1 - r, Jqq = A2 + 2.0*A1 - r - 2.0*Fz;
+    double det = (Jpp*Jqq - Jpq*Jpq);
+    if(!(std::abs(det) >= 1e-15)) det = 1e-15;
+    return {
+        {(Jqq/det)*(q*q), (-Jpq/det)*(q*q)},
+        {(-Jpq/det)*(q*q), (Jpp/det)*(q*q)}
+    };
+}
+
+std::pair<std::vector<std::vector<double>>, int> cov_weibull_observed(const FitContext& ctx, double c, double b) {
+    const WeibullLogs& lg = ctx.weibullLogs();
+    const int fails = static_cast<int>(lg.fails);
+    if (fails < 2) return {{{1,0},{0,1}}, fails};
+    WeibullSums s = weibull_sums(lg.d.data(), lg.d.size(), b);
+    return {weibull_observed_cov(s, lg.failSum, lg.fails, lg.lmax, c, b), fails};
+}
+
+double weibull_loglik_at_mle(const FitContext& ctx, double c, double b) {
+    const WeibullLogs& lg = ctx.weibullLogs();
+    const double r = static_cast<double>(lg.fails);
+    // В ОМП по c сумма (x/c)^b по всем наблюдениям равна r
+    return r * std::log(b) - r * b * std::log(c) + (b - 1.0) * (lg.failSum + r * lg.lmax) - r;
+}
+
+// ТРЕХПАРАМЕТРИЧЕСКИЙ ВЕЙБУЛЛ
+// При фиксированном пороге g правдоподобие - двухпараметрическое по x - g,
+// поэтому ищется максимум профиля ln L(g) = max_{c,b} ln L(c, b, g).
+// Порог параметризован s: g = x_min (1 - e^{-s}), так что сетка сгущается
+// у x_min, где профиль меняется быстрее всего. Уровень поиска - kCandidates
+// порогов параллельно; следующий уровень - та же сетка между соседями
+// лучшей точки. Каждое внутреннее решение стартует с формы b ближайшего
+// уже посчитанного порога, поэтому Ньютону хватает 2-4 итераций.
+namespace {
+struct ProfilePoint {
+    double s, g, c, b, l;
+};
+
+struct ShiftScratch {
+    std::vector<double> xs;
+    FitContext ctx{DataView(), CensView()};
+};
+}
+
+Weibull3Fit weibull_mle_3par(const FitContext& ctx, unsigned threads) {
+    const unsigned kCandidates = 16;
+    const double sMax = std::log(1e6);   // ближайший к x_min порог: x_min (1 - 1e-6)
+
+    Weibull3Fit fit;
+    const WeibullLogs& lg = ctx.weibullLogs();
+    auto base = weibull_mle_2par(ctx);
+    fit.c = base.first;
+    fit.b = base.second;
+    fit.solves = 1;
+    if (lg.fails < 3) return fit;
+    fit.logLik = fit.logLik2 = weibull_loglik_at_mle(ctx, fit.c, fit.b);
+
+    // Только x > 0, как в weibullLogs
+    std::vector<double> xp;
+    std::vector<int> rp;
+    xp.reserve(lg.d.size());
+    rp.reserve(lg.d.size());
+    double xmin = HUGE_VAL;
+    for (size_t i = 0; i < ctx.x.size(); ++i) {
+        if (ctx.x[i] <= 0) continue;
+        xp.push_back(ctx.x[i]);
+        rp.push_back(ctx.r[i]);
+        xmin = std::min(xmin, ctx.x[i]);
+    }
+
+    if (threads == 0) threads = default_thread_count();
+    threads = std::min(threads, kCandidates);
+    std::vector<ShiftScratch> scratch(threads);
+    for (ShiftScratch& sc : scratch) sc.xs.resize(xp.size());
+
+    // Посчитанные точки профиля по возрастанию s; s = 0 - двухпараметрическая
+    std::vector<ProfilePoint> known = {{0.0, 0.0, fit.c, fit.b, fit.logLik}};
+    std::vector<ProfilePoint> level(kCandidates);
+    double lo = 0, hi = sMax;
+    const int kDepth = 12;
+    for (int depth = 0; depth < kDepth && !ctx.stopRequested(); ++depth) {
+        if (ctx.control) ctx.control->setProgress(static_cast<double>(depth) / kDepth);
+        // Первый уровень включает правый край sMax, дальше - только внутренние точки
+        for (unsigned k = 0; k < kCandidates; ++k) {
+            level[k].s = depth == 0 ? hi * (k + 1) / kCandidates : lo + (hi - lo) * (k + 1) / (kCandidates + 1);
+            level[k].g = -xmin * std::expm1(-level[k].s);
+        }
+        parallel_for(kCandidates, threads, [&](size_t k, unsigned w) {
+            ShiftScratch& sc = scratch[w];
+            ProfilePoint& pt = level[k];
+            pt.l = -HUGE_VAL;
+            if (ctx.stopRequested()) return;
+            for (size_t i = 0; i < xp.size(); ++i) sc.xs[i] = xp[i] - pt.g;
+            sc.ctx.reset(sc.xs, rp);
+            auto near = std::lower_bound(known.begin(), known.end(), pt.s,
+                                         [](const ProfilePoint& a, double s) { return a.s < s; });
+            if (near == known.end() || (near != known.begin() && pt.s - near[-1].s < near->s - pt.s)) --near;
+            auto e = weibull_mle_2par(sc.ctx, near->b);
+            pt.c = e.first;
+            pt.b = e.second;
+            pt.l = weibull_loglik_at_mle(sc.ctx, pt.c, pt.b);
+        });
+        fit.solves += kCandidates;
+        known.insert(known.end(), level.begin(), level.end());
+        std::sort(known.begin(), known.end(), [](const ProfilePoint& a, const ProfilePoint& b) { return a.s < b.s; });
+
+        size_t best = 0;
+        for (size_t i = 1; i < known.size(); ++i)
+            if (known[i].l > known[best].l) best = i;
+        lo = known[best > 0 ? best - 1 : 0].s;
+        hi = known[std::min(best + 1, known.size() - 1)].s;
+        fit.c = known[best].c;
+        fit.b = known[best].b;
+        fit.g = known[best].g;
+        fit.logLik = known[best].l;
+        fit.boundary = best + 1 == known.size() && fit.b < 1.0;
+        if (xmin * (std::exp(-lo) - std::exp(-hi)) < 1e-9 * xmin) break;
     }
+    return fit;
+}
+
+std::pair<std::vector<std::vector<double>>, int> cov_weibull3_observed(const FitContext& ctx, double c, double b, double g) {
+    const int fails = static_cast<int>(ctx.weibullLogs().fails);
+    if (!(b > 2.0) || fails < 3) return {{}, fails};
+
+    // Минус ln L по (c, b, g); гессиан - автоматическим дифференцированием
+    auto nll = [&](const auto& p) {
+        auto lc = ad::log(p[0]);
+        decltype(lc) L = 0.0;
+        for (size_t i = 0; i < ctx.x.size(); ++i) {
+            if (ctx.x[i] <= 0) continue;
+            auto lz = ad::log(ctx.x[i] - p[2]) - lc;
+            L -= ad::exp(p[1] * lz);
+            if (ctx.r[i] == 0) L += ad::log(p[1]) - lc + (p[1] - 1.0) * lz;
+        }
+        return -L;
+    };
+    double x[3] = {c, b, g}, grad[3], H[9];
+    ad::value_hessian<3>(nll, x, grad, H);
+
+    // Обращение 3x3 через алгебраические дополнения
+    double cof[9];
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            int i1 = (i + 1) % 3, i2 = (i + 2) % 3, j1 = (j + 1) % 3, j2 = (j + 2) % 3;
+            cof[i * 3 + j] = H[i1 * 3 + j1] * H[i2 * 3 + j2] - H[i1 * 3 + j2] * H[i2 * 3 + j1];
+        }
+    }
+    double det = H[0] * cof[0] + H[1] * cof[1] + H[2] * cof[2];
+    // Главные миноры: информация должна быть положительно определенной
+    if (!(H[0] > 0 && cof[8] > 0 && det > 0)) return {{}, fails};
+    std::vector<std::vector<double>> cov(3, std::vector<double>(3));
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j) cov[i][j] = cof[j * 3 + i] / det;
+    return {cov, fails};
+}
+
+std::pair<double, double> weibull_mle_2par(DataView x, CensView r) {
+    FitContext ctx(x, r);
+    return weibull_mle_2par(ctx);
+}
+
+std::pair<double, double> normal_mle_2par(DataView x, CensView r) {
+    return normal_mle_2par(FitContext(x, r));
+}
+
+std::pair<double, double> weibull_regression_fallback(DataView x, CensView r) {
+    return weibull_regression_fallback(FitContext(x, r));
+}
+
+std::pair<std::vector<std::vector<double>>, int> cov_weibull_asymp_eff(DataView x, CensView r, double c, double b) {
+    return cov_weibull_asymp_eff(FitContext(x, r), c, b);
+}
+
+std::pair<std::vector<std::vector<double>>, int> cov_weibull_observed(DataView x, CensView r, double c, double b) {
+    return cov_weibull_observed(FitContext(x, r), c, b);
+}
+
+// ЦЕЛЕВЫЕ ФУНКЦИИ ДЛЯ NELDER-MEAD
+// Отказ дает логарифм плотности, цензурированное изделие - логарифм функции надежности
+double weibull_neg_loglik(const FitContext& ctx, DataView cb) {
+    double c = cb[0], b = cb[1];
+    if (c <= 0 || b <= 0) return 1e300;
+    double L = 0;
+    for (size_t i = 0; i < ctx.x.size(); ++i) {
+        double v = ctx.x[i];
+        if (v <= 0) continue;
+        double lz = std::log(v / c), zb = std::exp(b * lz);
+        if (ctx.r[i] == 0) L += std::log(b / c) + (b - 1.0) * lz - zb;
+        else L -= zb;
+    }
+    return -L;
+}
+
+double normal_neg_loglik(const FitContext& ctx, DataView mu_sigma) {
+    double mu = mu_sigma[0], sigma = mu_sigma[1];
+    if (sigma <= 0) return 1e300;
+    double L = 0;
+    for (size_t i = 0; i < ctx.x.size(); ++i) {
+        double z = (ctx.x[i] - mu) / sigma;
+        if (ctx.r[i] == 0) L += std::log(norm_pdf(z) / sigma);
+        else L += std::log(std::max(1e-300, 0.5 * std::erfc(z / std::sqrt(2.0))));
+    }
+    return -L;
+}
+
+Sample read_input_normal(const std::string& tag) {
+    Sample S;
+    InpSample in;
+    std::string error;
+    if (!parseInpFile("Inp/" + tag + ".inp", in, error)) return S;
+    S.x.swap(in.data);
+    S.r.swap(in.cens);
+    S.n = static_cast<int>(S.x.size());
     return S;
 }
 
@@ -5,6 +5,11 @@
 #include <string>
 #include <cmath>
 #include <algorithm>
+#include <functional>
+#include <memory>
+#include "runcontrol.h"
+#include "sampleview.h"
+#include "weibullkernel.h"
 
 
 struct PlotData {
@@ -34,13 +39,6 @@ struct PlotData {
 
 void calculate_weibull_intervals(PlotData& pd, const std::vector<double>& p_vec, double beta);
 
-struct OptData {
-    int n;
-    std::vector<double> x;
-    std::vector<int> r;
-};
-extern OptData globalOptData;
-
 struct Sample {
     std::vector<double> x;
     std::vector<int> r;
@@ -52,19 +50,172 @@ struct EmpiricalKM {
     std::vector<double> F_emp;
 };
 
-extern const std::vector<double>* G_X;
-extern const std::vector<int>* G_R;
+// Логарифмы для правдоподобия Вейбулла с цензурой: все наблюдения x > 0
+// (отказы и цензурированные), сдвинутые на max ln x, плюс суммы по отказам
+struct WeibullLogs {
+    std::vector<double> d;   // ln x_i - lmax
+    double lmax = 0;
+    size_t fails = 0;        // число отказов r
+    double failSum = 0;      // сумма d_i по отказам
+    double failVar = 0;      // дисперсия d_i по отказам (старт Ньютона)
+};
+
+// Отказы входят в правдоподобие нормального закона только через число,
+// среднее и сумму квадратов отклонений (Уэлфорд)
+struct NormalFailMoments {
+    double r = 0;
+    double mean = 0;
+    double M2 = 0;
+};
+
+// Суммы по цензурированным наблюдениям при z = (x - mu)/sigma,
+// Q(z) = 1 - Ф(z), h = ф(z)/Q(z) (функция риска), w = h (h - z) = h'(z)
+struct NormalSurvSums {
+    double lnQ = 0;
+    double h = 0, hz = 0;
+    double w = 0, wz = 0, wzz = 0;
+};
+
+// Разбиение выборки для нормального правдоподобия с цензурой
+struct NormalParts {
+    NormalFailMoments fail;
+    std::vector<double> surv;  // x цензурированных
+    double mean = 0, sd = 0;   // по всей выборке (делитель n) - старт Ньютона
+};
+
+class SampleCache;   // fitcache.h
+
+// Оценки и ковариация, которые методы запоминают в кеше выборки
+struct FitRecord {
+    std::vector<double> params;
+    std::vector<std::vector<double>> cov;
+    int fails = 0;
+};
+
+// Контекст одного расчета: представление выборки и рабочие буферы.
+// Каждый поток заводит свой контекст, поэтому оценки на разных потоках
+// выполняются одновременно без блокировок и глобального состояния.
+// Выборка не копируется: это может быть std::vector или отображенный в память файл.
+struct FitContext {
+    DataView x;
+    CensView r;
+    // Отмена и прогресс: контроль потока, создавшего контекст (runcontrol.h);
+    // потоки parallel_for наследуют его от вызывающего
+    RunControl* control = currentRunControl();
+
+    FitContext(DataView x_, CensView r_) : x(x_), r(r_) {}
+
+    // Новая выборка в том же контексте (буферы остаются, кеши сбрасываются)
+    void reset(DataView x_, CensView r_);
+
+    // Порядок по возрастанию x и оценка Каплана-Мейера считаются один раз
+    // на выборку и общие для фолбэка, МНК и графиков.
+    // sortedOrder() == nullptr - выборка уже упорядочена, сортировки не было.
+    const size_t* sortedOrder() const;
+    const EmpiricalKM& km() const;
+    // Один проход с логарифмами, общий для оценки и ковариации Вейбулла
+    const WeibullLogs& weibullLogs() const;
+    // Моменты отказов и цензурированные значения для нормального закона
+    const NormalParts& normalParts() const;
+
+    // Итерации оценок прерываются, когда расчет отменен
+    bool stopRequested() const { return control && control->cancelled(); }
+
+    // Общий кеш выборки (fitcache.h): порядок, КМ и оценки берутся из него
+    // и переживают контекст, так что следующий метод по тем же данным не
+    // сортирует и не оценивает заново. Без кеша все считается в контексте.
+    void attachCache(std::shared_ptr<SampleCache> cache);
+    // Оценка под ключом key: из кеша, если он подключен и оценка уже есть,
+    // иначе compute() (результат запоминается в кеше)
+    FitRecord memo(const std::string& key, const std::function<FitRecord()>& compute) const;
+
+private:
+    std::shared_ptr<SampleCache> shared;
+    mutable std::vector<size_t> order;
+    mutable EmpiricalKM kmCache;
+    mutable WeibullLogs logs;
+    mutable NormalParts normal;
+    mutable bool orderReady = false, kmReady = false, logsReady = false, normalReady = false;
+};
 
 
 double norm_pdf(double z);
 double norm_cdf(double z);
 double norm_ppf(double p);
-EmpiricalKM kaplan_meier_Itype(const std::vector<double>& x, const std::vector<int>& r);
-
-
-std::pair<double, double> weibull_mle_2par(const std::vector<double>& x, const std::vector<int>& r);
-std::pair<double, double> weibull_regression_fallback(const std::vector<double>& x, const std::vector<int>& r);
-std::pair<std::vector<std::vector<double>>, int> cov_weibull_asymp_eff(const std::vector<double>& x, const std::vector<int>& r, double c, double b);
+// Порядок выборки по возрастанию x (при равных x отказы раньше цензуры).
+// Если выборка уже так упорядочена, order остается пустым: проверка за O(n)
+// вместо сортировки. Иначе - radix_sort_order (radixsort.h).
+void km_sort_order(DataView x, CensView r, std::vector<size_t>& order);
+// КМ за один проход по упорядоченной выборке (order == nullptr - как есть).
+// Совпадающие моменты - одна ступень: S *= (n_risk - d) / n_risk, цензурированные
+// в тот же момент считаются еще под риском.
+EmpiricalKM kaplan_meier_sorted(DataView x, CensView r, const size_t* order);
+EmpiricalKM kaplan_meier_Itype(DataView x, CensView r);
+
+
+// ОМП Вейбулла по цензурированной выборке (тип I/II): отказы входят в
+// правдоподобие плотностью, цензурированные - функцией надежности.
+// b_start > 0 - стартовая форма для Ньютона (например, оценка по исходной
+// выборке при бутстрепе); иначе моментная оценка по логарифмам отказов.
+// Меньше двух отказов - оценка weibull_regression_fallback.
+std::pair<double, double> weibull_mle_2par(const FitContext& ctx, double b_start = 0);
+std::pair<double, double> weibull_regression_fallback(const FitContext& ctx);
+std::pair<std::vector<std::vector<double>>, int> cov_weibull_asymp_eff(const FitContext& ctx, double c, double b);
+// Ковариация оценок (ln c, 1/b) - обращенная наблюдаемая информация Фишера
+// правдоподобия с цензурой в точке (c, b); второе значение - число отказов
+std::pair<std::vector<std::vector<double>>, int> cov_weibull_observed(const FitContext& ctx, double c, double b);
+// То же по суммам ядра weibull_sums(d, b) по всем наблюдениям: L - сумма d
+// по r отказам, d = ln x - lmax. Используется и потоковым режимом.
+std::vector<std::vector<double>> weibull_observed_cov(const WeibullSums& s, double L, double r, double lmax,
+                                                      double c, double b);
+
+// ln L двухпараметрического Вейбулла в ОМП (c, b) по логарифмам контекста
+double weibull_loglik_at_mle(const FitContext& ctx, double c, double b);
+
+// Трехпараметрический Вейбулл F(x) = 1 - exp(-((x - g)/c)^b), x > g >= 0:
+// профиль правдоподобия по порогу g в [0, x_min) с weibull_mle_2par
+// внутри, кандидаты порога считаются параллельно (threads = 0 - по числу ядер).
+struct Weibull3Fit {
+    double c = 0, b = 0, g = 0;
+    double logLik = 0;       // ln L в оценке
+    double logLik2 = 0;      // ln L двухпараметрической модели (g = 0)
+    size_t solves = 0;       // решений weibull_mle_2par
+    bool boundary = false;   // максимум у x_min при b < 1: ОМП не существует
+};
+Weibull3Fit weibull_mle_3par(const FitContext& ctx, unsigned threads = 0);
+// Ковариация оценок (c, b, g) - обращенная наблюдаемая информация.
+// При b <= 2 задача нерегулярна (информация о пороге бесконечна) -
+// возвращается пустая матрица.
+std::pair<std::vector<std::vector<double>>, int> cov_weibull3_observed(const FitContext& ctx, double c, double b, double g);
+
+std::pair<double, double> weibull_mle_2par(DataView x, CensView r);
+// ОМП нормального закона с цензурой: отказы дают логарифм плотности,
+// цензурированные - ln Q(z). Без цензуры - среднее и СКО (делитель n);
+// меньше двух отказов - то же по всей выборке.
+std::pair<double, double> normal_mle_2par(const FitContext& ctx);
+// Ковариация оценок (a, sigma) - обращенная наблюдаемая информация Фишера
+std::pair<std::vector<std::vector<double>>, int> cov_normal_observed(const FitContext& ctx, double mu, double sigma);
+
+// Части нормального правдоподобия, общие с потоковым режимом.
+// normal_surv_sums добавляет слагаемые m цензурированных значений в acc;
+// withLnQ = false - только производные, acc.lnQ не меняется.
+void normal_surv_sums(const double* xs, size_t m, double mu, double sigma, NormalSurvSums& acc,
+                      bool withLnQ = true);
+// Ньютон с поиском вдоль направления; surv(mu, sigma) - суммы по всем
+// цензурированным (один проход на итерацию); control - досрочный выход
+std::pair<double, double> normal_mle_censored(const NormalFailMoments& f, double mu0, double sigma0,
+                                              const std::function<NormalSurvSums(double, double)>& surv,
+                                              const RunControl* control = nullptr);
+std::vector<std::vector<double>> normal_observed_cov(const NormalFailMoments& f, const NormalSurvSums& s,
+                                                     double mu, double sigma);
+std::pair<double, double> weibull_regression_fallback(DataView x, CensView r);
+std::pair<std::vector<std::vector<double>>, int> cov_weibull_asymp_eff(DataView x, CensView r, double c, double b);
+std::pair<std::vector<std::vector<double>>, int> cov_weibull_observed(DataView x, CensView r, double c, double b);
+std::pair<double, double> normal_mle_2par(DataView x, CensView r);
+
+// Целевые функции для neldermead (минус логарифм правдоподобия с учетом цензуры)
+double weibull_neg_loglik(const FitContext& ctx, DataView cb);       // {c, b}
+double normal_neg_loglik(const FitContext& ctx, DataView mu_sigma);  // {mu, sigma}
 
 
 Sample read_input_normal(const std::string& tag);
@@ -0,0 +1,169 @@
+#ifndef AUTODIFF_H
+#define AUTODIFF_H
+
+#include <array>
+#include <cmath>
+
+// Автоматическое дифференцирование прямым ходом на дуальных числах.
+// Dual<double, N> несет значение и N частных производных; вложенное
+// Dual<Dual<double, N>, N> дает вторые производные (точный гессиан).
+// Целевая функция пишется один раз шаблоном по типу T и вызывает
+// ad::exp, ad::log, ... - они перегружены и для double, и для Dual.
+namespace ad {
+
+template <class T, int N>
+struct Dual {
+    T v;
+    std::array<T, N> d;
+
+    Dual() : v(0) { d.fill(T(0)); }
+    Dual(double c) : v(c) { d.fill(T(0)); }
+    Dual(const T& val, const std::array<T, N>& der) : v(val), d(der) {}
+
+    // Независимая переменная номер i
+    static Dual variable(const T& val, int i) {
+        Dual r(0.0);
+        r.v = val;
+        r.d[i] = T(1.0);
+        return r;
+    }
+
+    Dual& operator+=(const Dual& b) { v += b.v; for (int i = 0; i < N; ++i) d[i] += b.d[i]; return *this; }
+    Dual& operator-=(const Dual& b) { v -= b.v; for (int i = 0; i < N; ++i) d[i] -= b.d[i]; return *this; }
+    Dual& operator*=(const Dual& b) { return *this = *this * b; }
+    Dual& operator/=(const Dual& b) { return *this = *this / b; }
+};
+
+// Значение без производных (для сравнений и ветвлений)
+inline double value(double x) { return x; }
+template <class T, int N>
+double value(const Dual<T, N>& x) { return value(x.v); }
+
+// Цепное правило: f(x) с производной df = f'(x.v)
+template <class T, int N>
+Dual<T, N> chain(const Dual<T, N>& x, const T& f, const T& df) {
+    Dual<T, N> r;
+    r.v = f;
+    for (int i = 0; i < N; ++i) r.d[i] = df * x.d[i];
+    return r;
+}
+
+template <class T, int N>
+Dual<T, N> operator-(const Dual<T, N>& a) {
+    Dual<T, N> r;
+    r.v = -a.v;
+    for (int i = 0; i < N; ++i) r.d[i] = -a.d[i];
+    return r;
+}
+template <class T, int N>
+Dual<T, N> operator+(Dual<T, N> a, const Dual<T, N>& b) { return a += b; }
+template <class T, int N>
+Dual<T, N> operator-(Dual<T, N> a, const Dual<T, N>& b) { return a -= b; }
+template <class T, int N>
+Dual<T, N> operator*(const Dual<T, N>& a, const Dual<T, N>& b) {
+    Dual<T, N> r;
+    r.v = a.v * b.v;
+    for (int i = 0; i < N; ++i) r.d[i] = a.d[i] * b.v + a.v * b.d[i];
+    return r;
+}
+template <class T, int N>
+Dual<T, N> operator/(const Dual<T, N>& a, const Dual<T, N>& b) {
+    T inv = T(1.0) / b.v;
+    Dual<T, N> r;
+    r.v = a.v * inv;
+    for (int i = 0; i < N; ++i) r.d[i] = (a.d[i] - r.v * b.d[i]) * inv;
+    return r;
+}
+
+// Смешанные операции с константами
+template <class T, int N>
+Dual<T, N> operator+(Dual<T, N> a, double b) { a.v += b; return a; }
+template <class T, int N>
+Dual<T, N> operator+(double a, Dual<T, N> b) { b.v += a; return b; }
+template <class T, int N>
+Dual<T, N> operator-(Dual<T, N> a, double b) { a.v -= b; return a; }
+template <class T, int N>
+Dual<T, N> operator-(double a, const Dual<T, N>& b) { Dual<T, N> r = -b; r.v += a; return r; }
+template <class T, int N>
+Dual<T, N> operator*(Dual<T, N> a, double b) {
+    a.v *= b;
+    for (int i = 0; i < N; ++i) a.d[i] *= b;
+    return a;
+}
+template <class T, int N>
+Dual<T, N> operator*(double a, const Dual<T, N>& b) { return b * a; }
+template <class T, int N>
+Dual<T, N> operator/(const Dual<T, N>& a, double b) { return a * (1.0 / b); }
+template <class T, int N>
+Dual<T, N> operator/(double a, const Dual<T, N>& b) {
+    T inv = T(1.0) / b.v;
+    return chain(b, a * inv, -a * inv * inv);
+}
+
+template <class T, int N>
+bool operator<(const Dual<T, N>& a, double b) { return value(a) < b; }
+template <class T, int N>
+bool operator>(const Dual<T, N>& a, double b) { return value(a) > b; }
+template <class T, int N>
+bool operator<=(const Dual<T, N>& a, double b) { return value(a) <= b; }
+template <class T, int N>
+bool operator>=(const Dual<T, N>& a, double b) { return value(a) >= b; }
+
+// Элементарные функции
+inline double exp(double x) { return std::exp(x); }
+inline double log(double x) { return std::log(x); }
+inline double log1p(double x) { return std::log1p(x); }
+inline double sqrt(double x) { return std::sqrt(x); }
+inline double pow(double x, double p) { return std::pow(x, p); }
+inline double erfc(double x) { return std::erfc(x); }
+
+template <class T, int N>
+Dual<T, N> exp(const Dual<T, N>& x) { T e = exp(x.v); return chain(x, e, e); }
+template <class T, int N>
+Dual<T, N> log(const Dual<T, N>& x) { return chain(x, log(x.v), T(1.0) / x.v); }
+template <class T, int N>
+Dual<T, N> log1p(const Dual<T, N>& x) { return chain(x, log1p(x.v), T(1.0) / (1.0 + x.v)); }
+template <class T, int N>
+Dual<T, N> sqrt(const Dual<T, N>& x) { T s = sqrt(x.v); return chain(x, s, 0.5 / s); }
+template <class T, int N>
+Dual<T, N> pow(const Dual<T, N>& x, double p) { return chain(x, pow(x.v, p), p * pow(x.v, p - 1.0)); }
+template <class T, int N>
+Dual<T, N> erfc(const Dual<T, N>& x) {
+    // d/dx erfc(x) = -2/sqrt(pi) * exp(-x^2)
+    return chain(x, erfc(x.v), -1.12837916709551257390 * exp(-(x.v * x.v)));
+}
+
+template <int N>
+using Grad = Dual<double, N>;
+template <int N>
+using Hess = Dual<Dual<double, N>, N>;
+
+// f(x) и градиент g за один вызов f на Grad<N>
+template <int N, class F>
+double value_gradient(const F& f, const double* x, double* g) {
+    std::array<Grad<N>, N> p;
+    for (int i = 0; i < N; ++i) p[i] = Grad<N>::variable(x[i], i);
+    Grad<N> r = f(p);
+    for (int i = 0; i < N; ++i) g[i] = r.d[i];
+    return r.v;
+}
+
+// f(x), градиент g и гессиан H (N*N по строкам) за один вызов f на Hess<N>
+template <int N, class F>
+double value_hessian(const F& f, const double* x, double* g, double* H) {
+    std::array<Hess<N>, N> p;
+    for (int i = 0; i < N; ++i) {
+        p[i].v = Grad<N>::variable(x[i], i);
+        p[i].d[i] = Grad<N>(1.0);
+    }
+    Hess<N> r = f(p);
+    for (int i = 0; i < N; ++i) {
+        g[i] = r.v.d[i];
+        for (int j = 0; j < N; ++j) H[i * N + j] = r.d[i].d[j];
+    }
+    return r.v.v;
+}
+
+} // namespace ad
+
+#endif // AUTODIFF_H
@@ -0,0 +1,90 @@
+#include "batchrunner.h"
+#include "fitcache.h"
+#include "parallel.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+static void printUsage() {
+    std::printf("Пакетная обработка .inp файлов без GUI\n\n"
+                "Использование: Batch_Agamirov [опции] <каталог|файл.inp|файл.smp|манифест>...\n\n"
+                "  --method ID    метод для всех файлов (по умолчанию - по имени файла)\n"
+                "  --threads N    число рабочих потоков (по умолчанию - по числу ядер)\n"
+                "  --out DIR      каталог для .out (по умолчанию - рядом с .inp)\n"
+                "  --stream       потоковые оценки MLE_Weibull/MLE_Normal порциями,\n"
+                "                 без загрузки выборки в память\n"
+                "  --chunk N      наблюдений в порции потокового режима (1048576)\n"
+                "  --convert      только перевести .inp в бинарный .smp (без расчета)\n"
+                "  --bootstrap N  бутстреп-интервалы Xp по N переоценкам (MLE_Weibull/MLE_Normal)\n"
+                "  --nonparam     непараметрический бутстреп (по умолчанию - параметрический)\n\n"
+                "Методы:");
+    for (const MethodInfo& info : methodRegistry()) std::printf(" %s", info.id);
+    std::printf("\n");
+}
+
+int main(int argc, char *argv[])
+{
+    const MethodInfo* method = nullptr;
+    BatchOptions opt;
+    std::string outDir;
+    bool convert = false;
+    std::vector<std::string> inputs;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--method" && hasValue) {
+            method = findMethod(argv[++i]);
+            if (!method) { std::fprintf(stderr, "Ошибка: неизвестный метод %s\n", argv[i]); return 2; }
+        } else if (arg == "--threads" && hasValue) {
+            opt.threads = static_cast<unsigned>(std::atoi(argv[++i]));
+        } else if (arg == "--stream") {
+            opt.stream = true;
+        } else if (arg == "--chunk" && hasValue) {
+            opt.chunk = static_cast<size_t>(std::max(1LL, std::atoll(argv[++i])));
+        } else if (arg == "--bootstrap" && hasValue) {
+            opt.bootstrap = static_cast<size_t>(std::max(0LL, std::atoll(argv[++i])));
+        } else if (arg == "--nonparam") {
+            opt.bootstrapNonparam = true;
+        } else if (arg == "--convert") {
+            convert = true;
+        } else if (arg == "--out" && hasValue) {
+            outDir = argv[++i];
+        } else if (arg == "-h" || arg == "--help") {
+            printUsage();
+            return 0;
+        } else {
+            inputs.push_back(arg);
+        }
+    }
+    if (inputs.empty()) { printUsage(); return 2; }
+
+    std::vector<std::string> files, errors;
+    std::string error;
+    if (!collectInputs(inputs, files, error)) {
+        std::fprintf(stderr, "Ошибка: %s\n", error.c_str());
+        return 2;
+    }
+
+    // Каждый файл - своя выборка: кеш методов только занимал бы память
+    fitCache().setEnabled(false);
+
+    BatchStats st;
+    if (convert) {
+        st = runConvert(files, outDir, opt, errors);
+    } else {
+        std::vector<BatchJob> jobs = makeJobs(files, method, outDir, errors);
+        st = runBatch(jobs, opt, errors);
+    }
+
+    for (const std::string& e : errors) std::fprintf(stderr, "Ошибка: %s\n", e.c_str());
+
+    double mb = static_cast<double>(st.bytes) / (1024.0 * 1024.0);
+    std::printf("Обработано файлов: %zu (ошибок: %zu), потоков: %u\n", st.files, errors.size(), st.threads);
+    std::printf("Время: %.3f с, пропускная способность: %.1f файлов/с, %.2f МБ/с\n",
+                st.seconds, st.seconds > 0 ? st.files / st.seconds : 0.0, st.seconds > 0 ? mb / st.seconds : 0.0);
+
+    return errors.empty() ? 0 : 1;
+}
@@ -0,0 +1,306 @@
+#include "batchrunner.h"
+#include "binarysample.h"
+#include "bootstrap.h"
+#include "inpformat.h"
+#include "parallel.h"
+#include "radixsort.h"
+#include "streamingfit.h"
+#include <QByteArray>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <set>
+
+namespace fs = std::filesystem;
+
+static std::string lower(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return std::tolower(c); });
+    return s;
+}
+
+static bool isBinary(const std::string& path) {
+    return lower(fs::path(path).extension().string()) == ".smp";
+}
+
+static bool isSampleFile(const std::string& path) {
+    return isBinary(path) || lower(fs::path(path).extension().string()) == ".inp";
+}
+
+const MethodInfo* findMethod(const std::string& id) {
+    const std::string key = lower(id);
+    for (const MethodInfo& info : methodRegistry()) {
+        if (lower(info.id) == key) return &info;
+    }
+    return nullptr;
+}
+
+const MethodInfo* detectMethod(const std::string& path) {
+    std::string stem = lower(fs::path(path).stem().string());
+    // Исторические имена входных файлов
+    static const std::pair<const char*, const char*> aliases[] = {{"grabbs", "Grubbs"}};
+    for (const auto& a : aliases) {
+        if (stem.find(a.first) != std::string::npos) return findMethod(a.second);
+    }
+
+    const MethodInfo* best = nullptr;
+    size_t bestLen = 0;
+    for (const MethodInfo& info : methodRegistry()) {
+        std::string id = lower(info.id);
+        if (id.size() > bestLen && stem.find(id) != std::string::npos) {
+            best = &info;
+            bestLen = id.size();
+        }
+    }
+    return best;
+}
+
+bool collectInputs(const std::vector<std::string>& args, std::vector<std::string>& files, std::string& error) {
+    std::error_code ec;
+    for (const std::string& arg : args) {
+        fs::path p(arg);
+        if (fs::is_directory(p, ec)) {
+            for (const auto& e : fs::recursive_directory_iterator(p, ec)) {
+                if (e.is_regular_file() && isSampleFile(e.path().string()))
+                    files.push_back(e.path().string());
+            }
+        } else if (isSampleFile(p.string())) {
+            files.push_back(p.string());
+        } else {
+            std::ifstream in(p);
+            if (!in) { error = "не удалось открыть " + arg; return false; }
+            std::string line;
+            while (std::getline(in, line)) {
+                line.erase(0, line.find_first_not_of(" \t\r"));
+                line.erase(line.find_last_not_of(" \t\r") + 1);
+                if (line.empty() || line[0] == '#') continue;
+                fs::path item(line);
+                if (item.is_relative()) item = p.parent_path() / item;
+                files.push_back(item.string());
+            }
+        }
+        if (ec) { error = arg + ": " + ec.message(); return false; }
+    }
+    return true;
+}
+
+std::vector<BatchJob> makeJobs(const std::vector<std::string>& files, const MethodInfo* method,
+                               const std::string& outDir, std::vector<std::string>& errors) {
+    std::vector<BatchJob> jobs;
+    jobs.reserve(files.size());
+    // После --convert рядом с X.inp лежит X.smp с той же выборкой: считается
+    // только .smp, иначе оба задания писали бы в один X.out
+    std::set<std::string> binaries, outputs;
+    for (const std::string& f : files)
+        if (isBinary(f)) binaries.insert(fs::path(f).replace_extension().string());
+    for (const std::string& f : files) {
+        if (!isBinary(f) && binaries.count(fs::path(f).replace_extension().string())) continue;
+        BatchJob job;
+        job.input = f;
+        job.method = method ? method : detectMethod(f);
+        if (!job.method) { errors.push_back(f + ": не удалось определить метод по имени файла"); continue; }
+
+        fs::path out = outDir.empty() ? fs::path(f) : fs::path(outDir) / fs::path(f).filename();
+        out.replace_extension(".out");
+        job.output = out.string();
+        // Два задания с одним выходом гонялись бы за файл, и один отчет пропал бы
+        if (!outputs.insert(fs::absolute(out).lexically_normal().string()).second) {
+            errors.push_back(f + ": выходной файл " + job.output + " уже занят другим входом, пропущен");
+            continue;
+        }
+
+        std::error_code ec;
+        job.bytes = fs::file_size(f, ec);
+        if (ec) job.bytes = 0;
+        jobs.push_back(job);
+    }
+    // Крупные файлы первыми - иначе хвост из одного большого файла держит все ядра
+    std::stable_sort(jobs.begin(), jobs.end(), [](const BatchJob& a, const BatchJob& b) { return a.bytes > b.bytes; });
+    return jobs;
+}
+
+// Бутстреп-интервалы квантилей по оценкам res.params (только MLE_Weibull / MLE_Normal)
+static QString bootstrapReport(const BatchJob& job, const MethodResult& res, DataView data, CensView cens,
+                               const BatchOptions& opt, unsigned threads) {
+    const std::string id = job.method->id;
+    if ((id != "MLE_Weibull" && id != "MLE_Normal") || res.params.size() != 2) return QString();
+
+    BootstrapOptions bo;
+    bo.model = (id == "MLE_Weibull") ? BootstrapModel::Weibull : BootstrapModel::Normal;
+    bo.kind = opt.bootstrapNonparam ? BootstrapKind::Nonparametric : BootstrapKind::Parametric;
+    bo.resamples = opt.bootstrap;
+    bo.threads = threads;
+
+    std::vector<double> probs;
+    for (const QuantileRow& row : res.quantiles) probs.push_back(row.p);
+
+    BootstrapResult br;
+    if (!bootstrap_quantiles(data, cens, res.params[0], res.params[1], probs, bo, br))
+        return "Bootstrap: недостаточно данных\n";
+
+    QString out;
+    out += QString("Bootstrap: %1, B=%2, beta=%3, успешных переоценок %4\n")
+               .arg(opt.bootstrapNonparam ? "непараметрический" : "параметрический")
+               .arg(static_cast<qulonglong>(bo.resamples)).arg(bo.beta)
+               .arg(static_cast<qulonglong>(br.ok));
+    QString xp_low, xp_up;
+    for (size_t k = 0; k < probs.size(); ++k) {
+        xp_low += QString::number(br.low[k], 'f', 12) + " ; ";
+        xp_up  += QString::number(br.up[k], 'f', 12) + " ; ";
+    }
+    out += "Xp_low_boot\n" + xp_low + "\n";
+    out += "Xp_up_boot\n" + xp_up + "\n";
+    return out;
+}
+
+static bool calculateInMemory(const BatchJob& job, const AbstractMethod* method, const BatchOptions& opt,
+                              unsigned innerThreads, QString& report, std::string& error) {
+    MappedSample mapped;
+    thread_local InpSample parsed; // буфер разбора свой у каждого потока и переживает задания
+    DataView data;
+    CensView cens;
+    if (isBinary(job.input)) {
+        // .smp отдается методу прямо из отображенных страниц, без разбора и копий
+        if (!mapped.open(job.input, error)) return false;
+        data = mapped.times();
+        cens = mapped.cens();
+    } else {
+        if (!parseInpFile(job.input, parsed, error)) return false;
+        data = parsed.data;
+        cens = parsed.cens;
+    }
+
+    const MethodResult res = method->calculate(data, cens, false);
+    report = res.report;
+    if (opt.bootstrap) report += bootstrapReport(job, res, data, cens, opt, innerThreads);
+    return true;
+}
+
+// Потоковый режим: файл читается порциями, выборка целиком в памяти не хранится
+static bool calculateStreaming(const BatchJob& job, size_t chunk, QString& report, std::string& error) {
+    const std::string id = job.method->id;
+    if (id != "MLE_Weibull" && id != "MLE_Normal") {
+        error = job.input + ": потоковый режим есть только у MLE_Weibull и MLE_Normal";
+        return false;
+    }
+
+    InpChunkReader inpReader;
+    MappedSample sample;
+    std::unique_ptr<MappedChunkSource> smpReader;
+    SampleChunkSource* reader = &inpReader;
+    if (isBinary(job.input)) {
+        if (!sample.open(job.input, error)) return false;
+        smpReader.reset(new MappedChunkSource(sample));
+        reader = smpReader.get();
+    } else if (!inpReader.open(job.input, error)) {
+        return false;
+    }
+
+    StreamFitResult fit;
+    bool weibull = (id == "MLE_Weibull");
+    bool ok = weibull ? weibull_mle_stream(*reader, fit, chunk) : normal_mle_stream(*reader, fit, chunk);
+    if (!ok) { error = job.input + ": нет наблюдений или оценка не сошлась"; return false; }
+
+    MethodResult res;
+    report = QString("Method:%1\n").arg(id.c_str());
+    report += QString("n=%1\n").arg(static_cast<qulonglong>(fit.n));
+    report += QString("Потоковый режим: X и R не выводятся, проходов по данным: %1\n").arg(fit.passes);
+    int n = static_cast<int>(fit.n);
+    report += weibull ? Method_MLE_Weibull::estimatesReport(res, n, fit.p1, fit.p2, fit.cov)
+                      : Method_MLE_Normal::estimatesReport(res, n, fit.p1, fit.p2, fit.cov);
+    return true;
+}
+
+static bool processJob(const BatchJob& job, const AbstractMethod* method, const BatchOptions& opt,
+                       unsigned innerThreads, std::string& error) {
+    QString report;
+    bool ok = opt.stream ? calculateStreaming(job, opt.chunk, report, error)
+                         : calculateInMemory(job, method, opt, innerThreads, report, error);
+    if (!ok) return false;
+
+    QString out;
+    out += "================================================================================\n";
+    out += "Анализ данных - Результаты расчета\n";
+    out += QString("Метод: %1\n").arg(QString::fromUtf8(job.method->title));
+    out += QString("Файл: %1\n").arg(QString::fromStdString(job.input));
+    out += "================================================================================\n\n";
+    out += report;
+
+    QByteArray bytes = out.toUtf8();
+    std::ofstream file(job.output, std::ios::binary | std::ios::trunc);
+    if (!file) { error = job.output + ": не удалось открыть для записи"; return false; }
+    file.write(bytes.constData(), bytes.size());
+
+    if (report.startsWith("Ошибка") || report.startsWith("Error")) {
+        error = job.input + ": " + report.toStdString();
+        return false;
+    }
+    return true;
+}
+
+BatchStats runBatch(const std::vector<BatchJob>& jobs, const BatchOptions& opt, std::vector<std::string>& errors) {
+    BatchStats st;
+    st.threads = opt.threads ? opt.threads : default_thread_count();
+    st.files = jobs.size();
+    for (const BatchJob& j : jobs) st.bytes += j.bytes;
+
+    // Методы не хранят состояние, поэтому один экземпляр на метод обслуживает
+    // все потоки; ошибки копятся по потокам - в горячем цикле нет блокировок
+    const std::vector<MethodInfo>& reg = methodRegistry();
+    std::vector<std::unique_ptr<const AbstractMethod>> methods;
+    for (const MethodInfo& info : reg) methods.emplace_back(info.create());
+    std::vector<std::vector<std::string>> workerErrors(st.threads);
+    // Ядра уже заняты файлами; бутстреп и сортировка внутри задания
+    // параллелятся, только если файл один
+    const unsigned innerThreads = jobs.size() == 1 ? st.threads : 1;
+    set_radix_sort_threads(innerThreads);
+
+    auto t0 = std::chrono::steady_clock::now();
+    parallel_for(jobs.size(), st.threads, [&](size_t i, unsigned wi) {
+        const BatchJob& job = jobs[i];
+        const AbstractMethod* method = methods[static_cast<size_t>(job.method - reg.data())].get();
+
+        std::string err;
+        if (!processJob(job, method, opt, innerThreads, err)) workerErrors[wi].push_back(err);
+    });
+    st.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    for (const auto& we : workerErrors) {
+        st.failed += we.size();
+        errors.insert(errors.end(), we.begin(), we.end());
+    }
+    return st;
+}
+
+BatchStats runConvert(const std::vector<std::string>& files, const std::string& outDir,
+                      const BatchOptions& opt, std::vector<std::string>& errors) {
+    BatchStats st;
+    st.threads = opt.threads ? opt.threads : default_thread_count();
+    st.files = files.size();
+    std::vector<std::vector<std::string>> workerErrors(st.threads);
+
+    auto t0 = std::chrono::steady_clock::now();
+    parallel_for(files.size(), st.threads, [&](size_t i, unsigned wi) {
+        const std::string& f = files[i];
+        if (isBinary(f)) return;
+        fs::path out = outDir.empty() ? fs::path(f) : fs::path(outDir) / fs::path(f).filename();
+        out.replace_extension(".smp");
+
+        std::string err;
+        if (!convertInpToBinary(f, out.string(), err)) workerErrors[wi].push_back(err);
+    });
+    st.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    for (const std::string& f : files) {
+        std::error_code ec;
+        std::uintmax_t sz = fs::file_size(f, ec);
+        if (!ec) st.bytes += sz;
+    }
+    for (const auto& we : workerErrors) {
+        st.failed += we.size();
+        errors.insert(errors.end(), we.begin(), we.end());
+    }
+    return st;
+}
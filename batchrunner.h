@@ -0,0 +1,57 @@
+#ifndef BATCHRUNNER_H
+#define BATCHRUNNER_H
+
+#include "MethodRegistry.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Одно задание пакетной обработки: входной .inp, выходной .out и метод
+struct BatchJob {
+    std::string input;
+    std::string output;
+    const MethodInfo* method = nullptr;
+    std::uintmax_t bytes = 0;
+};
+
+struct BatchOptions {
+    unsigned threads = 0;              // 0 - по числу ядер
+    bool stream = false;               // потоковые оценки без загрузки файла в память
+    size_t chunk = size_t(1) << 20;    // наблюдений в порции потокового режима
+    size_t bootstrap = 0;              // переоценок для бутстреп-интервалов Xp (0 - нет)
+    bool bootstrapNonparam = false;    // непараметрический бутстреп вместо параметрического
+};
+
+struct BatchStats {
+    size_t files = 0;
+    size_t failed = 0;
+    std::uintmax_t bytes = 0;
+    double seconds = 0;
+    unsigned threads = 1;
+};
+
+// Поиск метода по id (без учета регистра)
+const MethodInfo* findMethod(const std::string& id);
+// Определение метода по имени файла (MLE_Weibull.inp, Grabbs.inp, ...)
+const MethodInfo* detectMethod(const std::string& path);
+
+// Разворачивает аргументы в список .inp/.smp файлов: каталог обходится рекурсивно,
+// .inp и .smp берутся как есть, любой другой файл считается манифестом
+// (один путь на строку, относительные пути - от каталога манифеста).
+bool collectInputs(const std::vector<std::string>& args, std::vector<std::string>& files, std::string& error);
+
+// Формирует задания; method == nullptr - автоопределение по имени файла.
+// outDir пустой - .out кладется рядом с входным файлом. Если в списке есть
+// и X.inp, и X.smp (результат --convert), считается только X.smp. Вход, чей .out
+// совпал с выходом уже принятого задания, не ставится и попадает в errors.
+std::vector<BatchJob> makeJobs(const std::vector<std::string>& files, const MethodInfo* method,
+                               const std::string& outDir, std::vector<std::string>& errors);
+
+// Конвертирует .inp в бинарный .smp (в outDir или рядом с исходным файлом)
+BatchStats runConvert(const std::vector<std::string>& files, const std::string& outDir,
+                      const BatchOptions& opt, std::vector<std::string>& errors);
+
+// Обрабатывает задания на пуле потоков
+BatchStats runBatch(const std::vector<BatchJob>& jobs, const BatchOptions& opt, std::vector<std::string>& errors);
+
+#endif // BATCHRUNNER_H
@@ -0,0 +1,1178 @@
+#include "MethodRegistry.h"
+#include "analysis.h"
+#include "bootstrap.h"
+#include "fitcache.h"
+#include "gradopt.h"
+#include "groupstats.h"
+#include "grubbs.h"
+#include "inpformat.h"
+#include "neldermead.h"
+#include "normaldist.h"
+#include "parallel.h"
+#include "plotlod.h"
+#include "radixsort.h"
+#include "ranksum.h"
+#include "shapirowilk.h"
+#include "streamingfit.h"
+#include "weibullkernel.h"
+#include <boost/math/distributions/normal.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Замер: минимальное время из reps запусков, секунды
+template <class F>
+static double timeit(F&& f, int reps) {
+    double best = 1e300;
+    for (int i = 0; i < reps; ++i) {
+        auto t0 = std::chrono::steady_clock::now();
+        f();
+        best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count());
+    }
+    return best;
+}
+
+static volatile double g_sink;
+
+// Прежние norm_cdf / norm_ppf: распределение boost на каждый вызов
+static double boost_norm_cdf(double z) {
+    boost::math::normal_distribution<> N(0.0, 1.0);
+    return boost::math::cdf(N, z);
+}
+
+static double boost_norm_ppf(double p) {
+    boost::math::normal_distribution<> N(0.0, 1.0);
+    return boost::math::quantile(N, p);
+}
+
+static void makeWeibull(size_t n, double censFrac, std::vector<double>& x, std::vector<int>& r) {
+    std::mt19937_64 gen(12345);
+    std::weibull_distribution<double> w(1.7, 5000.0);
+    std::bernoulli_distribution cens(censFrac);
+    x.resize(n); r.resize(n);
+    for (size_t i = 0; i < n; ++i) { x[i] = w(gen); r[i] = cens(gen) ? 1 : 0; }
+}
+
+// Прежний weibull_mle_2par (только отказы, без правдоподобия цензурированных):
+// log и pow на каждом наблюдении в каждой итерации Ньютона
+static double weibull_mle_reference(const std::vector<double>& x, const std::vector<int>& r) {
+    std::vector<double> obs;
+    for (size_t i = 0; i < x.size(); ++i) if (r[i] == 0) obs.push_back(x[i]);
+    double b = weibull_regression_fallback(x, r).second;
+    for (int it = 0; it < 100; ++it) {
+        double S0 = 0, S1 = 0, S2 = 0, L = 0;
+        for (double v : obs) {
+            double lv = std::log(v), vb = std::pow(v, b);
+            S0 += vb; S1 += vb*lv; S2 += vb*lv*lv; L += lv;
+        }
+        double f = (L/obs.size()) - (S1/S0) + 1.0/b;
+        double df = -(S2*S0 - S1*S1)/(S0*S0) - 1.0/(b*b);
+        double step = f/df;
+        b -= step;
+        if (std::abs(step) < 1e-7) break;
+    }
+    return b;
+}
+
+static void benchWeibullKernel() {
+    std::printf("== weibull_sums (ядро: %s) ==\n", weibull_kernel_name());
+    std::printf("%10s %14s %14s %14s %9s %9s\n", "n", "old iter, ms", "scalar, ms", "simd, ms", "x scalar", "x old");
+    for (size_t n : {size_t(100000), size_t(1000000), size_t(10000000)}) {
+        std::vector<double> x; std::vector<int> r;
+        makeWeibull(n, 0.0, x, r);
+        std::vector<double> d(n);
+        double lmax = -HUGE_VAL;
+        for (size_t i = 0; i < n; ++i) { d[i] = std::log(x[i]); lmax = std::max(lmax, d[i]); }
+        for (double& v : d) v -= lmax;
+
+        const double b = 1.7;
+        int reps = n >= 10000000 ? 3 : 10;
+        double tOld = timeit([&] {
+            double S0 = 0, S1 = 0, S2 = 0;
+            for (double v : x) { double lv = std::log(v), vb = std::pow(v, b); S0 += vb; S1 += vb*lv; S2 += vb*lv*lv; }
+            g_sink = S0 + S1 + S2;
+        }, reps);
+        double tScalar = timeit([&] { g_sink = weibull_sums_scalar(d.data(), n, b).S0; }, reps);
+        double tSimd = timeit([&] { g_sink = weibull_sums(d.data(), n, b).S0; }, reps);
+        std::printf("%10zu %14.3f %14.3f %14.3f %9.2f %9.2f\n", n, tOld * 1e3, tScalar * 1e3, tSimd * 1e3,
+                    tScalar / tSimd, tOld / tSimd);
+    }
+
+    // Старый вариант включает стартовую оценку weibull_regression_fallback (сортировка),
+    // новый стартует от моментов логарифмов отказов
+    std::printf("\n== weibull_mle_2par целиком (20%% цензуры) ==\n");
+    std::printf("%10s %14s %14s %14s %9s\n", "n", "old, ms", "new, ms", "fallback, ms", "x");
+    for (size_t n : {size_t(100000), size_t(1000000), size_t(10000000)}) {
+        std::vector<double> x; std::vector<int> r;
+        makeWeibull(n, 0.2, x, r);
+        FitContext ctx(x, r);
+        int reps = n >= 10000000 ? 1 : 3;
+        double tOld = timeit([&] { g_sink = weibull_mle_reference(x, r); }, reps);
+        double tNew = timeit([&] { g_sink = weibull_mle_2par(ctx).second; }, reps);
+        double tFb = timeit([&] { g_sink = weibull_regression_fallback(ctx).second; }, reps);
+        std::printf("%10zu %14.1f %14.1f %14.1f %9.2f\n", n, tOld * 1e3, tNew * 1e3, tFb * 1e3, tOld / tNew);
+    }
+}
+
+static std::string makeInpText(size_t n) {
+    std::vector<double> x; std::vector<int> r;
+    makeWeibull(n, 0.2, x, r);
+    std::string text = "Samples_size\n" + std::to_string(n) + "\nbeta\n0.95\nData\n";
+    char num[32];
+    for (size_t i = 0; i < n; ++i) {
+        std::snprintf(num, sizeof(num), "%.6f%c", x[i], (i % 10 == 9) ? '\n' : ' ');
+        text += num;
+    }
+    text += "\nCensorizes\n";
+    for (size_t i = 0; i < n; ++i) { text += r[i] ? '1' : '0'; text += (i % 40 == 39) ? '\n' : ' '; }
+    text += "\nkp\n3\nP\n0.1 0.5 0.9\n";
+    return text;
+}
+
+// Прежний read_input_normal: std::string на лексему и stod/stoi в try/catch
+static size_t parse_reference(const std::string& text) {
+    std::istringstream in(text);
+    std::string tmp;
+    int n = 0;
+    in >> tmp >> n;
+    std::vector<double> x; std::vector<int> r;
+    while (in >> tmp && tmp != "X" && tmp != "Data");
+    for (int i = 0; i < n; ++i) {
+        std::string val; in >> val;
+        if (val == ",") { i--; continue; }
+        try { x.push_back(std::stod(val)); } catch (...) {}
+    }
+    while (in >> tmp && (tmp != "R" && tmp != "Censorizes"));
+    for (int i = 0; i < n; ++i) {
+        std::string val; in >> val;
+        if (val == ",") { i--; continue; }
+        try { r.push_back(std::stoi(val)); } catch (...) {}
+    }
+    return x.size() + r.size();
+}
+
+static void benchInpParser() {
+    std::printf("\n== разбор .inp (from_chars, без выделений на лексему) ==\n");
+    std::printf("%10s %10s %12s %12s %12s %12s %9s\n", "n", "MB", "old, ms", "new, ms", "old, MB/s", "new, MB/s", "x");
+    InpSample s;
+    for (size_t n : {size_t(100000), size_t(1000000), size_t(5000000)}) {
+        const std::string text = makeInpText(n);
+        const double mb = static_cast<double>(text.size()) / (1024.0 * 1024.0);
+        int reps = n >= 5000000 ? 2 : 5;
+        double tOld = timeit([&] { g_sink = static_cast<double>(parse_reference(text)); }, reps);
+        double tNew = timeit([&] {
+            parseInpBuffer(text.data(), text.data() + text.size(), s);
+            g_sink = static_cast<double>(s.data.size() + s.cens.size());
+        }, reps);
+        std::printf("%10zu %10.1f %12.1f %12.1f %12.1f %12.1f %9.2f\n", n, mb, tOld * 1e3, tNew * 1e3,
+                    mb / tOld, mb / tNew, tOld / tNew);
+    }
+}
+
+static void benchBootstrap() {
+    std::printf("\n== бутстреп квантилей Вейбулла (n=1000, 20%% цензуры, B=10000) ==\n");
+    std::printf("%16s %8s %12s %9s\n", "вид", "потоков", "время, ms", "успешных");
+    std::vector<double> x; std::vector<int> r;
+    makeWeibull(1000, 0.2, x, r);
+    auto est = weibull_mle_2par(x, r);
+    const std::vector<double> probs = {0.01, 0.1, 0.5, 0.9, 0.99};
+
+    for (BootstrapKind kind : {BootstrapKind::Parametric, BootstrapKind::Nonparametric}) {
+        for (unsigned threads : {1u, default_thread_count()}) {
+            BootstrapOptions opt;
+            opt.kind = kind;
+            opt.threads = threads;
+            BootstrapResult res;
+            bootstrap_quantiles(x, r, est.first, est.second, probs, opt, res);
+            std::printf("%16s %8u %12.1f %9zu\n", kind == BootstrapKind::Parametric ? "parametric" : "nonparametric",
+                        threads, res.seconds * 1e3, res.ok);
+        }
+    }
+}
+
+static void benchRankSum() {
+    std::printf("\n== точное распределение суммы рангов Уилкоксона ==\n");
+    std::printf("%6s %6s %12s %12s %12s %12s\n", "m", "n", "счет, ms", "из кеша, us", "таблица, KB", "рабочие, KB");
+    const int sizes[][2] = {{10, 10}, {20, 30}, {50, 50}, {100, 100}, {100, 300}, {200, 200}, {250, 250}};
+    for (const auto& mn : sizes) {
+        std::shared_ptr<const RankSumDistribution> d;
+        double tFirst = timeit([&] { d = rank_sum_exact(mn[0], mn[1]); }, 1);
+        size_t work = rank_sum_last_work_bytes();
+        double tCached = timeit([&] { g_sink = rank_sum_exact(mn[0], mn[1])->cdf(0); }, 100);
+        std::printf("%6d %6d %12.2f %12.2f %12.1f %12.1f\n", mn[0], mn[1], tFirst * 1e3, tCached * 1e6,
+                    d->bytes() / 1024.0, work / 1024.0);
+    }
+
+    // Совпадения: 30% значений в группах по 3
+    std::printf("%6s %6s %12s %12s %12s   (с совпадениями)\n", "m", "n", "счет, ms", "", "рабочие, KB");
+    for (int N : {40, 100, 200}) {
+        std::vector<int> ties;
+        for (int left = N; left > 0;) {
+            int t = (ties.size() % 3 == 0) ? std::min(3, left) : 1;
+            ties.push_back(t);
+            left -= t;
+        }
+        double t = timeit([&] { g_sink = rank_sum_exact_ties(N / 2, ties)->cdf(0); }, 1);
+        std::printf("%6d %6d %12.2f %12s %12.1f\n", N / 2, N - N / 2, t * 1e3, "", rank_sum_last_work_bytes() / 1024.0);
+    }
+}
+
+static void benchShapiroWilk() {
+    std::printf("\n== Шапиро-Уилк: коэффициенты и квантили ==\n");
+    std::printf("%8s %14s %14s %14s %14s\n", "n", "old, us", "cold, us", "warm, us", "p-value");
+    for (int n : {50, 500, 5000}) {
+        std::mt19937_64 gen(7);
+        std::normal_distribution<double> nd(10.0, 2.0);
+        std::vector<double> x(static_cast<size_t>(n));
+        for (double& v : x) v = nd(gen);
+        std::sort(x.begin(), x.end());
+
+        // Прежний расчет: n вызовов boost::math::quantile на каждый тест
+        double tOld = timeit([&] {
+            std::vector<double> m(static_cast<size_t>(n));
+            double norm = 0;
+            for (int i = 1; i <= n; ++i) { m[i-1] = boost_norm_ppf((i - 0.375) / (n + 0.25)); norm += m[i-1] * m[i-1]; }
+            double b = 0;
+            for (int i = 0; i < n; ++i) b += m[i] / std::sqrt(norm) * x[i];
+            g_sink = b;
+        }, 20);
+        double tCold = timeit([&] { g_sink = (*swilk_coefficients(n))[0]; }, 1); // первый вызов для n
+        double w = 0;
+        double tWarm = timeit([&] { w = swilk_statistic(x.data(), n, *swilk_coefficients(n)); }, 20);
+        std::printf("%8d %14.1f %14.1f %14.1f %14.4f\n", n, tOld * 1e6, tCold * 1e6, tWarm * 1e6, swilk_pvalue(w, n));
+    }
+
+    const size_t N = 1000000;
+    std::vector<double> p(N), out(N);
+    for (size_t i = 0; i < N; ++i) p[i] = (i + 0.5) / N;
+    double tBoost = timeit([&] { for (size_t i = 0; i < N; ++i) out[i] = boost_norm_ppf(p[i]); }, 3);
+    double tBatch = timeit([&] { norm_ppf_batch(p.data(), out.data(), N); }, 3);
+    std::printf("norm_ppf x1e6: boost %.1f ms, norm_ppf_batch %.1f ms (x%.1f)\n", tBoost * 1e3, tBatch * 1e3, tBoost / tBatch);
+}
+
+// Прежний критерий Граббса, повторенный k раз: на каждом шаге два прохода
+// (среднее, СКО) по оставшейся выборке, поиск крайнего и удаление
+static int grubbs_esd_reference(std::vector<double> x, int k, double alpha, double* lastStat) {
+    using namespace boost::math;
+    int outliers = 0;
+    for (int step = 1; step <= k && x.size() >= 3; ++step) {
+        double n = static_cast<double>(x.size());
+        double mean = 0;
+        for (double v : x) mean += v;
+        mean /= n;
+        double sq = 0;
+        for (double v : x) sq += (v - mean) * (v - mean);
+        double s = std::sqrt(sq / (n - 1.0));
+        size_t far = 0;
+        for (size_t i = 1; i < x.size(); ++i)
+            if (std::abs(x[i] - mean) > std::abs(x[far] - mean)) far = i;
+        double u = std::abs(x[far] - mean) / s;
+        students_t dist(n - 2);
+        double t = quantile(complement(dist, alpha / (2.0 * n)));
+        double crit = ((n - 1.0) / std::sqrt(n)) * std::sqrt((t * t) / (n - 2.0 + t * t));
+        if (u > crit) outliers = step;
+        *lastStat = u;
+        x.erase(x.begin() + far);
+    }
+    return outliers;
+}
+
+static void benchGrubbs() {
+    std::printf("\n== обобщенный критерий Граббса (ESD) ==\n");
+    std::printf("%9s %5s %14s %14s %14s %9s %12s\n", "n", "k", "old, ms", "esd, ms", "esd warm, ms", "выбросов", "|dR| посл.");
+    for (size_t n : {size_t(1000), size_t(100000), size_t(1000000)}) {
+        for (int k : {10, 100}) {
+            std::mt19937_64 gen(11);
+            std::normal_distribution<double> nd(0.0, 1.0);
+            std::vector<double> x(n);
+            for (double& v : x) v = nd(gen);
+            for (int i = 0; i < k / 2; ++i) x[static_cast<size_t>(i) * (n / k)] = (i % 2 ? -1.0 : 1.0) * (8.0 + i);
+
+            double refStat = 0;
+            int refOut = 0;
+            double tOld = timeit([&] { refOut = grubbs_esd_reference(x, k, 0.05, &refStat); }, n > 100000 ? 1 : 3);
+            // Первый прогон считает новые квантили (часть n_i уже в кеше от
+            // строки с меньшим k), повторный берет все из кеша
+            GrubbsEsd esd;
+            double tCold = timeit([&] { esd = grubbs_esd(x, k, 0.05, 0); }, 1);
+            double tWarm = timeit([&] { esd = grubbs_esd(x, k, 0.05, 0); }, 5);
+            std::printf("%9zu %5d %14.2f %14.2f %14.2f %4d/%-4d %12.2e\n", n, k, tOld * 1e3, tCold * 1e3, tWarm * 1e3,
+                        esd.outliers, refOut, std::abs(esd.steps.back().statistic - refStat));
+        }
+    }
+}
+
+// Прежний разбор групп ANOVA: копия каждой группы и второй проход для дисперсии
+static void benchGroupStats() {
+    std::printf("\n== сводки групп (ANOVA, Фишер-Стьюдент) ==\n");
+    std::printf("%10s %14s %14s %14s %14s\n", "n группы", "copy+2pass, ms", "moments_of, ms", "8 потоков, ms", "|ds|/s");
+    for (size_t n : {size_t(10000), size_t(1000000), size_t(10000000)}) {
+        std::mt19937_64 gen(5);
+        std::normal_distribution<double> nd(100.0, 15.0);
+        std::vector<double> x(n);
+        for (double& v : x) v = nd(gen);
+        double sOld = 0;
+        double tOld = timeit([&] {
+            std::vector<double> v;
+            double sum = 0;
+            for (double val : x) { v.push_back(val); sum += val; }
+            double mean = sum / n, sq = 0;
+            for (double val : v) sq += (val - mean) * (val - mean);
+            sOld = std::sqrt(sq / (n - 1.0));
+        }, 3);
+        Moments m1, m8;
+        double t1 = timeit([&] { m1 = moments_of(x, 1); }, 3);
+        double t8 = timeit([&] { m8 = moments_of(x, 8); }, 3);
+        if (m1.m2 != m8.m2 || m1.mean != m8.mean) std::printf("  (!) результат зависит от числа потоков\n");
+        std::printf("%10zu %14.2f %14.2f %14.2f %14.2e\n", n, tOld * 1e3, t1 * 1e3, t8 * 1e3,
+                    std::abs(std::sqrt(m1.variance()) - sOld) / sOld);
+    }
+}
+
+// Попарные сравнения после ANOVA: таблица размаха строится при первом
+// вызове для k, дальше все пары - по ней; при k = 2 Тьюки и Геймс-Хауэлл
+// обязаны совпасть с t-критериями (объединенным и Уэлча)
+static void benchPostHoc() {
+    std::printf("\n== попарные сравнения (Тьюки HSD, Геймс-Хауэлл) ==\n");
+    std::mt19937_64 gen(3);
+    std::normal_distribution<double> nd(0.0, 1.0);
+    std::vector<double> a(20), b(27);
+    for (double& v : a) v = nd(gen);
+    for (double& v : b) v = 0.6 + 1.7 * nd(gen);
+    Moments ma = moments_of(a), mb = moments_of(b);
+    PostHoc two = post_hoc({ma, mb}, 0.05);
+    TwoSampleTests t = two_sample_tests(ma, mb);
+    std::printf("k = 2: |p_T - p_t| = %.2e, |p_GH - p_Welch| = %.2e\n",
+                std::abs(two.pairs[0].pTukey - t.pPooled), std::abs(two.pairs[0].pGames - t.pWelch));
+
+    std::printf("%6s %10s %14s %14s\n", "k", "пар", "первый, ms", "повторный, ms");
+    for (int k : {10, 50, 200}) {
+        std::vector<Moments> groups;
+        for (int i = 0; i < k; ++i) {
+            std::vector<double> x(static_cast<size_t>(50 + i));
+            for (double& v : x) v = 0.01 * i + (1 + i % 3) * nd(gen);
+            groups.push_back(moments_of(x));
+        }
+        PostHoc ph;
+        double tFirst = timeit([&] { ph = post_hoc(groups, 0.05); }, 1);
+        double tWarm = timeit([&] { ph = post_hoc(groups, 0.05); }, 3);
+        std::printf("%6d %10zu %14.2f %14.2f\n", k, ph.pairs.size(), tFirst * 1e3, tWarm * 1e3);
+    }
+}
+
+// Точность Ф, Q и квантиля относительно boost на всей области, где значения
+// не денормализованы, и пропускная способность (вычислений/с)
+static void benchNormalDist() {
+    std::printf("\n== norm_cdf / norm_ppf против boost (erfc: %s) ==\n", erfc_kernel_name());
+    const size_t N = 2000000;
+    std::vector<double> z(N), p(N), out(N), ref(N);
+    for (size_t i = 0; i < N; ++i) z[i] = -38.0 + 47.0 * i / (N - 1);
+    // Вероятности равномерно по логарифму к обоим краям: 1e-300 .. 0.5 .. 1 - 5e-16
+    for (size_t i = 0; i < N; ++i) {
+        double t = static_cast<double>(i) / (N - 1);
+        p[i] = t < 0.5 ? std::pow(10.0, -300.0 * (1.0 - 2.0 * t)) * 0.5 : 1.0 - 0.5 * std::pow(10.0, -15.0 * (2.0 * t - 1.0));
+    }
+
+    auto maxRel = [&](const std::vector<double>& a) {
+        double worst = 0;
+        for (size_t i = 0; i < N; ++i) {
+            if (!(std::abs(ref[i]) >= 2.3e-308)) continue;
+            worst = std::max(worst, std::abs(a[i] - ref[i]) / std::abs(ref[i]));
+        }
+        return worst;
+    };
+
+    std::printf("%-22s %14s %16s\n", "функция", "max отн. ошибка", "вычислений/с");
+    auto row = [&](const char* name, double err, double t) {
+        std::printf("%-22s %14.2e %16.3g\n", name, err, N / t);
+    };
+
+    double t = timeit([&] { for (size_t i = 0; i < N; ++i) ref[i] = boost_norm_cdf(z[i]); }, 1);
+    row("boost cdf", 0.0, t);
+    t = timeit([&] { for (size_t i = 0; i < N; ++i) out[i] = norm_cdf(z[i]); }, 3);
+    row("norm_cdf", maxRel(out), t);
+    t = timeit([&] { norm_cdf_batch(z.data(), out.data(), N); }, 3);
+    row("norm_cdf_batch", maxRel(out), t);
+
+    boost::math::normal_distribution<> nd(0.0, 1.0);
+    for (size_t i = 0; i < N; ++i) ref[i] = boost::math::cdf(boost::math::complement(nd, z[i]));
+    t = timeit([&] { norm_sf_batch(z.data(), out.data(), N); }, 3);
+    row("norm_sf_batch", maxRel(out), t);
+
+    t = timeit([&] { for (size_t i = 0; i < N; ++i) ref[i] = boost_norm_ppf(p[i]); }, 1);
+    row("boost quantile", 0.0, t);
+    t = timeit([&] { for (size_t i = 0; i < N; ++i) out[i] = norm_ppf(p[i]); }, 3);
+    row("norm_ppf", maxRel(out), t);
+    t = timeit([&] { norm_ppf_batch(p.data(), out.data(), N); }, 3);
+    row("norm_ppf_batch", maxRel(out), t);
+}
+
+// НАБОР ЗАМЕРОВ
+// Каждый замер параметризован объемом n и долей цензуры; число повторов
+// подбирается удвоением, пока суммарное время не превысит minTime
+// (как в Google Benchmark). JSON совместим по полям с --benchmark_format=json,
+// поэтому выпуски можно сравнивать его compare.py.
+
+struct BenchParams {
+    size_t n;
+    double cens;
+};
+
+struct BenchDef {
+    std::string name;
+    bool usesCens;   // перебирать долю цензуры
+    size_t maxN;     // выше этого n замер не имеет смысла
+    // Готовит данные и возвращает одну операцию
+    std::function<std::function<void()>(const BenchParams&)> make;
+};
+
+struct BenchRun {
+    std::string name;
+    BenchParams params;
+    size_t iterations;
+    double realNs, cpuNs;   // на одну итерацию
+};
+
+static void makeNormal(size_t n, double censFrac, std::vector<double>& x, std::vector<int>& r) {
+    std::mt19937_64 gen(54321);
+    std::normal_distribution<double> nd(100.0, 15.0);
+    std::bernoulli_distribution cens(censFrac);
+    x.resize(n); r.resize(n);
+    for (size_t i = 0; i < n; ++i) { x[i] = nd(gen); r[i] = cens(gen) ? 1 : 0; }
+}
+
+// Входные данные метода в его позиционном формате (см. Method_*::buildReport)
+static void methodInput(const std::string& id, size_t n, double censFrac, std::vector<double>& data, std::vector<int>& cens) {
+    std::vector<double> x;
+    std::vector<int> r;
+    const bool weibull = id.find("Weibull") != std::string::npos;
+    if (weibull) makeWeibull(n, censFrac, x, r);
+    else makeNormal(n, censFrac, x, r);
+
+    const double dn = static_cast<double>(n);
+    const size_t half = n / 2;
+    if (id == "Grubbs") {
+        data = {dn, 0, 0.05, 100.0, 15.0};
+        data.insert(data.end(), x.begin(), x.end());
+    } else if (id == "GrubbsESD") {
+        data = {dn, 0, 0.05, 10};
+        data.insert(data.end(), x.begin(), x.end());
+    } else if (id == "ShapiroWilk") {
+        data = {dn};
+        data.insert(data.end(), x.begin(), x.end());
+    } else if (id == "FisherStudent") {
+        data = {0.05, static_cast<double>(half)};
+        data.insert(data.end(), x.begin(), x.begin() + half);
+        data.push_back(static_cast<double>(n - half));
+        data.insert(data.end(), x.begin() + half, x.end());
+    } else if (id == "Wilcoxon") {
+        data = {0.05, static_cast<double>(half), static_cast<double>(n - half), 0};
+        data.insert(data.end(), x.begin(), x.end());
+    } else if (id == "Anova") {
+        const size_t k = 4;
+        data = {static_cast<double>(k)};
+        for (size_t g = 0; g < k; ++g) {
+            size_t b = g * n / k, e = (g + 1) * n / k;
+            data.push_back(static_cast<double>(e - b));
+            data.insert(data.end(), x.begin() + b, x.begin() + e);
+        }
+    } else {
+        data = x;
+        cens = r;
+        return;
+    }
+    cens.assign(data.size(), 0);
+}
+
+// Выборка и контекст замера живут, пока жива возвращаемая операция
+struct BenchSample {
+    std::vector<double> x;
+    std::vector<int> r;
+    FitContext ctx{DataView(), CensView()};
+};
+
+static std::shared_ptr<BenchSample> weibullSample(const BenchParams& p) {
+    auto s = std::make_shared<BenchSample>();
+    makeWeibull(p.n, p.cens, s->x, s->r);
+    s->ctx = FitContext(s->x, s->r);
+    return s;
+}
+
+static std::shared_ptr<BenchSample> normalSample(const BenchParams& p) {
+    auto s = std::make_shared<BenchSample>();
+    makeNormal(p.n, p.cens, s->x, s->r);
+    s->ctx = FitContext(s->x, s->r);
+    return s;
+}
+
+// Минус логарифм правдоподобия шаблоном для gradopt: Вейбулл в (ln c, ln b),
+// нормальный в (mu, ln sigma). Логарифмы наработок считаются заранее.
+struct LogSample {
+    std::vector<double> lx;
+    double fails = 0, failLogSum = 0;
+};
+
+static std::shared_ptr<LogSample> logSample(const BenchSample& s) {
+    auto l = std::make_shared<LogSample>();
+    l->lx.resize(s.x.size());
+    for (size_t i = 0; i < s.x.size(); ++i) {
+        l->lx[i] = std::log(s.x[i]);
+        if (s.r[i] == 0) { l->fails += 1; l->failLogSum += l->lx[i]; }
+    }
+    return l;
+}
+
+static auto weibullNll(const LogSample& l) {
+    return [&l](const auto& p) {
+        auto lc = p[0];
+        auto b = ad::exp(p[1]);
+        decltype(lc + b) S = 0.0;
+        for (double v : l.lx) S += ad::exp(b * (v - lc));
+        return S - l.fails * (ad::log(b) - lc) - (b - 1.0) * (l.failLogSum - l.fails * lc);
+    };
+}
+
+static auto normalNll(const BenchSample& s) {
+    return [&s](const auto& p) {
+        auto mu = p[0], ls = p[1];
+        auto inv = ad::exp(-ls);
+        decltype(mu + ls) L = 0.0;
+        for (size_t i = 0; i < s.x.size(); ++i) {
+            auto z = (s.x[i] - mu) * inv;
+            if (s.r[i] == 0) L += ls + 0.5 * z * z;
+            else L -= ad::log(0.5 * ad::erfc(z * 0.70710678118654752440));
+        }
+        return L;
+    };
+}
+
+// Число вычислений функции и время до сходимости: Нелдер-Мид против L-BFGS и
+// Ньютона с доверительной областью на тех же правдоподобиях
+static void benchGradOpt() {
+    std::printf("\n== neldermead против gradopt (n = 100000, цензура 0.3) ==\n");
+    std::printf("%-28s %12s %12s %10s %10s\n", "метод", "параметр 1", "параметр 2", "вычислений", "мс");
+    auto row = [](const char* name, double a, double b, long evals, double t) {
+        std::printf("%-28s %12.6f %12.6f %10ld %10.2f\n", name, a, b, evals, t * 1e3);
+    };
+
+    std::vector<double> x, cb;
+    std::vector<int> r;
+    makeWeibull(100000, 0.3, x, r);
+    FitContext ctx(x, r);
+    long evals = 0;
+    double t = timeit([&] {
+        evals = 0;
+        cb = {4000.0, 1.2};
+        neldermead(cb, 1e-8, [&](DataView v) { ++evals; return weibull_neg_loglik(ctx, v); });
+    }, 1);
+    row("weibull/neldermead", cb[0], cb[1], evals, t);
+
+    BenchSample ws;
+    makeWeibull(100000, 0.3, ws.x, ws.r);
+    auto l = logSample(ws);
+    std::vector<double> x0 = {std::log(4000.0), std::log(1.2)};
+    GradOptResult g;
+    t = timeit([&] { g = lbfgs_minimize<2>(weibullNll(*l), x0); }, 1);
+    row("weibull/lbfgs", std::exp(g.x[0]), std::exp(g.x[1]), g.evaluations, t);
+    t = timeit([&] { g = trust_region_minimize<2>(weibullNll(*l), x0); }, 1);
+    row("weibull/trust_region", std::exp(g.x[0]), std::exp(g.x[1]), g.evaluations, t);
+
+    BenchSample ns;
+    makeNormal(100000, 0.3, ns.x, ns.r);
+    ns.ctx = FitContext(ns.x, ns.r);
+    std::vector<double> ms;
+    t = timeit([&] {
+        evals = 0;
+        ms = {90.0, 10.0};
+        neldermead(ms, 1e-8, [&](DataView v) { ++evals; return normal_neg_loglik(ns.ctx, v); });
+    }, 1);
+    row("normal/neldermead", ms[0], ms[1], evals, t);
+    x0 = {90.0, std::log(10.0)};
+    t = timeit([&] { g = lbfgs_minimize<2>(normalNll(ns), x0); }, 1);
+    row("normal/lbfgs", g.x[0], std::exp(g.x[1]), g.evaluations, t);
+    t = timeit([&] { g = trust_region_minimize<2>(normalNll(ns), x0); }, 1);
+    row("normal/trust_region", g.x[0], std::exp(g.x[1]), g.evaluations, t);
+}
+
+// Цепочка методов по одной выборке: без кеша, первый прогон с кешем и
+// повтор (как при смене только P или beta в MainWindow)
+static void benchFitCache() {
+    std::printf("\n== кеш выборки: MLE_Weibull + MLS_Weibull + MLE_Weibull3, n = 100000 ==\n");
+    std::vector<double> x;
+    std::vector<int> r;
+    makeWeibull(100000, 0.2, x, r);
+    const char* ids[] = {"MLE_Weibull", "MLS_Weibull", "MLE_Weibull3"};
+    auto chain = [&] {
+        for (const char* id : ids) {
+            for (const MethodInfo& info : methodRegistry()) {
+                if (std::strcmp(info.id, id) != 0) continue;
+                std::unique_ptr<AbstractMethod> m(info.create());
+                g_sink = m->calculate(x, r, true).params[0];
+            }
+        }
+    };
+
+    double tOff = timeit(chain, 3);
+    fitCache().setEnabled(true);
+    fitCache().clear();
+    double tCold = timeit(chain, 1);
+    double tWarm = timeit(chain, 3);
+    fitCache().setEnabled(false);
+    std::printf("без кеша %.1f ms, первый прогон %.1f ms, повтор %.1f ms (x%.1f), хеш выборки %.2f ms\n",
+                tOff * 1e3, tCold * 1e3, tWarm * 1e3, tOff / tWarm,
+                timeit([&] { g_sink = static_cast<double>(sample_key(x, r).h1); }, 5) * 1e3);
+}
+
+// Оценки в своих FitContext на многих потоках обязаны совпасть до бита с
+// последовательным расчетом: общего состояния между контекстами нет.
+// 320 выборок Вейбулла и нормальных разного объема и цензуры, три прогона
+// по всем выборкам через parallel_for; false - есть расхождение.
+static bool checkConcurrentFits() {
+    const size_t samples = 320;
+    const size_t width = 9;   // c, b, cov (4), отказы, mu, sigma
+    const unsigned threads = std::max(8u, default_thread_count());
+    std::printf("\n== параллельные оценки против последовательных (%zu выборок, %u потоков) ==\n", samples, threads);
+
+    std::vector<std::vector<double>> xs(samples), ys(samples);
+    std::vector<std::vector<int>> rs(samples);
+    for (size_t i = 0; i < samples; ++i) {
+        std::mt19937_64 gen(1000 + i);
+        std::weibull_distribution<double> w(0.8 + 0.01 * (i % 200), 5000.0);
+        std::normal_distribution<double> nd(100.0, 15.0);
+        std::bernoulli_distribution cens(0.15 * (i % 4));
+        const size_t n = 10 + (i * 97) % 5000;
+        xs[i].resize(n); ys[i].resize(n); rs[i].resize(n);
+        for (size_t j = 0; j < n; ++j) { xs[i][j] = w(gen); ys[i][j] = nd(gen); rs[i][j] = cens(gen) ? 1 : 0; }
+    }
+
+    auto fit = [&](size_t i, double* out) {
+        FitContext wctx(xs[i], rs[i]);
+        auto cb = weibull_mle_2par(wctx);
+        auto cov = cov_weibull_asymp_eff(wctx, cb.first, cb.second);
+        out[0] = cb.first;
+        out[1] = cb.second;
+        for (size_t k = 0; k < 4; ++k) out[2 + k] = cov.first.size() == 2 ? cov.first[k / 2][k % 2] : 0.0;
+        out[6] = cov.second;
+        FitContext nctx(ys[i], rs[i]);
+        auto ms = normal_mle_2par(nctx);
+        out[7] = ms.first;
+        out[8] = ms.second;
+    };
+
+    std::vector<double> serial(samples * width);
+    double tSerial = timeit([&] { for (size_t i = 0; i < samples; ++i) fit(i, &serial[i * width]); }, 1);
+
+    size_t mismatches = 0;
+    double tParallel = 0;
+    for (int round = 0; round < 3; ++round) {
+        std::vector<double> par(samples * width);
+        tParallel += timeit([&] { parallel_for(samples, threads, [&](size_t i, unsigned) { fit(i, &par[i * width]); }); }, 1);
+        for (size_t i = 0; i < samples; ++i) {
+            if (std::memcmp(&par[i * width], &serial[i * width], width * sizeof(double)) == 0) continue;
+            if (mismatches++ < 10) std::printf("расхождение: выборка %zu, прогон %d\n", i, round + 1);
+        }
+    }
+    std::printf("последовательно %.1f ms, параллельно %.1f ms на прогон, расхождений %zu из %zu\n",
+                tSerial * 1e3, tParallel / 3 * 1e3, mismatches, 3 * samples);
+    return mismatches == 0;
+}
+
+// Выборка в памяти как источник порций для потоковых оценок
+class VectorChunkSource : public SampleChunkSource {
+public:
+    VectorChunkSource(const std::vector<double>& x_, const std::vector<int>& r_) : x(x_), r(r_) {}
+    void rewind() override { pos = 0; }
+    bool next(std::vector<double>& cx, std::vector<int>& cr, size_t maxCount) override {
+        size_t end = std::min(x.size(), pos + maxCount);
+        cx.assign(x.begin() + pos, x.begin() + end);
+        cr.assign(r.begin() + pos, r.begin() + end);
+        pos = end;
+        return !cx.empty();
+    }
+
+private:
+    const std::vector<double>& x;
+    const std::vector<int>& r;
+    size_t pos = 0;
+};
+
+// Потоковые оценки (streamingfit.h) против оценок в памяти: параметры и
+// ковариация с относительной точностью 1e-7 (ковариация - относительно ее
+// наибольшего элемента). Без цензуры, с цензурой и с 0-1 отказами,
+// порциями меньше выборки; false - есть расхождение.
+static bool checkStreamingFits() {
+    std::printf("\n== потоковые оценки против оценок в памяти ==\n");
+    std::printf("%-8s %8s %9s %8s %14s %14s\n", "модель", "n", "отказов", "порция", "отклонение", "");
+    const double tol = 1e-7;
+    size_t failed = 0;
+
+    auto relDiff = [](double a, double b, double scale) { return std::abs(a - b) / std::max(scale, 1e-300); };
+    auto compare = [&](const char* model, const std::vector<double>& x, const std::vector<int>& r, size_t chunk,
+                       bool ok, const StreamFitResult& s, std::pair<double, double> est,
+                       const std::vector<std::vector<double>>& cov) {
+        double dev = 0;
+        if (ok && s.cov.size() == 2 && cov.size() == 2) {
+            dev = std::max(relDiff(s.p1, est.first, std::abs(est.first)), relDiff(s.p2, est.second, std::abs(est.second)));
+            double cmax = 0;
+            for (const auto& row : cov) for (double v : row) cmax = std::max(cmax, std::abs(v));
+            for (size_t i = 0; i < 2; ++i)
+                for (size_t j = 0; j < 2; ++j) dev = std::max(dev, relDiff(s.cov[i][j], cov[i][j], cmax));
+        }
+        bool pass = ok && dev <= tol;
+        if (!pass) ++failed;
+        size_t fails = 0;
+        for (int ri : r) fails += ri == 0;
+        std::printf("%-8s %8zu %9zu %8zu %14.3g %14s\n", model, x.size(), fails, chunk, dev,
+                    pass ? "" : (ok ? "РАСХОЖДЕНИЕ" : "НЕТ ОЦЕНКИ"));
+    };
+
+    for (size_t n : {1000, 200000}) {
+        for (double cens : {0.0, 0.3, 0.7}) {
+            for (int fewFails : {-1, 0, 1}) {
+                if (fewFails >= 0 && cens != 0.7) continue;
+                std::vector<double> wx, nx;
+                std::vector<int> r;
+                makeWeibull(n, cens, wx, r);
+                std::vector<int> tmp;
+                makeNormal(n, cens, nx, tmp);
+                if (fewFails >= 0) {
+                    // Меньше двух отказов - фолбэки обеих оценок
+                    std::fill(r.begin(), r.end(), 1);
+                    if (fewFails == 1) r[n / 2] = 0;
+                }
+                const size_t chunk = n / 7 + 1;
+
+                VectorChunkSource ws(wx, r);
+                StreamFitResult sw;
+                bool okW = weibull_mle_stream(ws, sw, chunk);
+                FitContext wctx(wx, r);
+                auto cb = weibull_mle_2par(wctx);
+                compare("weibull", wx, r, chunk, okW, sw, cb, cov_weibull_observed(wctx, cb.first, cb.second).first);
+
+                VectorChunkSource ns(nx, r);
+                StreamFitResult sn;
+                bool okN = normal_mle_stream(ns, sn, chunk);
+                FitContext nctx(nx, r);
+                auto ms = normal_mle_2par(nctx);
+                compare("normal", nx, r, chunk, okN, sn, ms, cov_normal_observed(nctx, ms.first, ms.second).first);
+            }
+        }
+    }
+    std::printf("расхождений: %zu\n", failed);
+    return failed == 0;
+}
+
+// Вероятностная бумага Вейбулла по n наработкам (как у MLE_Weibull) на
+// логарифмической оси; видимая область - весь график, 800x600 пикселей
+struct PlotLodBench {
+    LodSeries series;
+    PlotViewport view;
+};
+
+static std::shared_ptr<PlotLodBench> plotLodBench(size_t n, bool scatter) {
+    std::vector<double> x;
+    std::vector<int> r;
+    makeWeibull(n, 0.0, x, r);
+    std::sort(x.begin(), x.end());
+    GraphSeriesData g;
+    g.isScatter = scatter;
+    g.x = x;
+    g.y.resize(n);
+    std::mt19937_64 gen(7);
+    std::normal_distribution<double> noise(0.0, 0.05);
+    for (size_t i = 0; i < n; ++i)
+        g.y[i] = 5.0 + std::log(-std::log(1.0 - (i + 0.3) / (n + 0.4))) + (scatter ? 0.0 : noise(gen));
+    PlotViewport v;
+    v.logX = true;
+    v.xMin = x.front() * 0.7; v.xMax = x.back() * 1.3;
+    v.yMin = -15; v.yMax = 8;
+    return std::make_shared<PlotLodBench>(PlotLodBench{LodSeries(g, true), v});
+}
+
+static std::vector<BenchDef> benchSuite() {
+    std::vector<BenchDef> suite;
+    const size_t all = size_t(10000000);
+
+    suite.push_back({"weibull_mle_2par", true, all, [](const BenchParams& p) {
+        auto s = weibullSample(p);
+        // Новый контекст на вызов: кеш порядка и КМ не переносится между итерациями
+        return std::function<void()>([s] { g_sink = weibull_mle_2par(s->x, s->r).second; });
+    }});
+    suite.push_back({"normal_mle_2par", true, all, [](const BenchParams& p) {
+        auto s = normalSample(p);
+        return std::function<void()>([s] { g_sink = normal_mle_2par(s->x, s->r).second; });
+    }});
+    // Прежняя оценка: среднее и СКО всей выборки без учета цензуры - база для
+    // сравнения стоимости ОМП с цензурой
+    suite.push_back({"normal_mle_2par/closed_form", true, all, [](const BenchParams& p) {
+        auto s = normalSample(p);
+        return std::function<void()>([s] {
+            const std::vector<double>& x = s->x;
+            double sum = 0;
+            for (double v : x) sum += v;
+            double mu = sum / x.size(), sq = 0;
+            for (double v : x) sq += (v - mu) * (v - mu);
+            g_sink = std::sqrt(sq / x.size());
+        });
+    }});
+    suite.push_back({"weibull_mle_3par", true, all, [](const BenchParams& p) {
+        auto s = weibullSample(p);
+        return std::function<void()>([s] { g_sink = weibull_mle_3par(s->ctx).g; });
+    }});
+    suite.push_back({"weibull_regression_fallback", true, all, [](const BenchParams& p) {
+        auto s = weibullSample(p);
+        return std::function<void()>([s] { g_sink = weibull_regression_fallback(s->x, s->r).second; });
+    }});
+    suite.push_back({"kaplan_meier_Itype", true, all, [](const BenchParams& p) {
+        auto s = weibullSample(p);
+        return std::function<void()>([s] { g_sink = static_cast<double>(kaplan_meier_Itype(s->x, s->r).F_emp.size()); });
+    }});
+    suite.push_back({"kaplan_meier_Itype/presorted", true, all, [](const BenchParams& p) {
+        auto s = weibullSample(p);
+        std::vector<size_t> order;
+        km_sort_order(s->x, s->r, order);
+        std::vector<double> x(s->x.size());
+        std::vector<int> r(s->r.size());
+        for (size_t i = 0; i < order.size(); ++i) { x[i] = s->x[order[i]]; r[i] = s->r[order[i]]; }
+        s->x.swap(x);
+        s->r.swap(r);
+        return std::function<void()>([s] { g_sink = static_cast<double>(kaplan_meier_Itype(s->x, s->r).F_emp.size()); });
+    }});
+    // Прежняя сортировка номеров сравнением против поразрядной
+    suite.push_back({"sort_order/std_sort", true, all, [](const BenchParams& p) {
+        auto s = weibullSample(p);
+        auto order = std::make_shared<std::vector<size_t>>();
+        return std::function<void()>([s, order] {
+            const std::vector<double>& x = s->x;
+            const std::vector<int>& r = s->r;
+            order->resize(x.size());
+            std::iota(order->begin(), order->end(), size_t(0));
+            std::sort(order->begin(), order->end(), [&](size_t a, size_t b) {
+                return x[a] < x[b] || (x[a] == x[b] && r[a] == 0 && r[b] != 0);
+            });
+            g_sink = static_cast<double>(order->front());
+        });
+    }});
+    suite.push_back({"sort_order/radix", true, all, [](const BenchParams& p) {
+        auto s = weibullSample(p);
+        auto order = std::make_shared<std::vector<size_t>>();
+        return std::function<void()>([s, order] {
+            radix_sort_order(s->x, s->r, *order, 1);
+            g_sink = static_cast<double>(order->front());
+        });
+    }});
+    suite.push_back({"sort_order/radix_parallel", true, all, [](const BenchParams& p) {
+        auto s = weibullSample(p);
+        auto order = std::make_shared<std::vector<size_t>>();
+        return std::function<void()>([s, order] {
+            radix_sort_order(s->x, s->r, *order, default_thread_count());
+            g_sink = static_cast<double>(order->front());
+        });
+    }});
+    suite.push_back({"cov_weibull_asymp_eff", true, all, [](const BenchParams& p) {
+        auto s = weibullSample(p);
+        return std::function<void()>([s] { g_sink = cov_weibull_asymp_eff(s->ctx, 5000.0, 1.7).first[0][0]; });
+    }});
+    suite.push_back({"cov_weibull_observed", true, all, [](const BenchParams& p) {
+        auto s = weibullSample(p);
+        return std::function<void()>([s] { g_sink = cov_weibull_observed(s->ctx, 5000.0, 1.7).first[0][0]; });
+    }});
+    suite.push_back({"neldermead/weibull_neg_loglik", true, size_t(1000000), [](const BenchParams& p) {
+        auto s = weibullSample(p);
+        return std::function<void()>([s] {
+            std::vector<double> cb = {4000.0, 1.2};
+            neldermead(cb, 1e-8, [&](DataView v) { return weibull_neg_loglik(s->ctx, v); });
+            g_sink = cb[1];
+        });
+    }});
+    suite.push_back({"neldermead/restarts:8", true, size_t(1000000), [](const BenchParams& p) {
+        auto s = weibullSample(p);
+        return std::function<void()>([s] {
+            NelderMeadOptions opt;
+            opt.restarts = 8;
+            std::vector<double> cb = {4000.0, 1.2};
+            g_sink = nelder_mead([&](DataView v) { return weibull_neg_loglik(s->ctx, v); }, cb, opt).best.x[1];
+        });
+    }});
+    suite.push_back({"gradopt/lbfgs/weibull", true, size_t(1000000), [](const BenchParams& p) {
+        auto s = weibullSample(p);
+        auto l = logSample(*s);
+        return std::function<void()>([s, l] {
+            std::vector<double> x0 = {std::log(4000.0), std::log(1.2)};
+            g_sink = lbfgs_minimize<2>(weibullNll(*l), x0).x[1];
+        });
+    }});
+    suite.push_back({"gradopt/trust_region/weibull", true, size_t(1000000), [](const BenchParams& p) {
+        auto s = weibullSample(p);
+        auto l = logSample(*s);
+        return std::function<void()>([s, l] {
+            std::vector<double> x0 = {std::log(4000.0), std::log(1.2)};
+            g_sink = trust_region_minimize<2>(weibullNll(*l), x0).x[1];
+        });
+    }});
+    suite.push_back({"norm_ppf", false, all, [](const BenchParams& p) {
+        auto probs = std::make_shared<std::vector<double>>(p.n);
+        for (size_t i = 0; i < p.n; ++i) (*probs)[i] = (i + 0.5) / p.n;
+        return std::function<void()>([probs] {
+            double acc = 0;
+            for (double v : *probs) acc += norm_ppf(v);
+            g_sink = acc;
+        });
+    }});
+    suite.push_back({"norm_ppf_batch", false, all, [](const BenchParams& p) {
+        auto probs = std::make_shared<std::vector<double>>(p.n);
+        auto out = std::make_shared<std::vector<double>>(p.n);
+        for (size_t i = 0; i < p.n; ++i) (*probs)[i] = (i + 0.5) / p.n;
+        return std::function<void()>([probs, out] {
+            norm_ppf_batch(probs->data(), out->data(), probs->size());
+            g_sink = out->front();
+        });
+    }});
+    suite.push_back({"norm_cdf", false, all, [](const BenchParams& p) {
+        auto z = std::make_shared<std::vector<double>>(p.n);
+        for (size_t i = 0; i < p.n; ++i) (*z)[i] = -6.0 + 12.0 * (i + 0.5) / p.n;
+        return std::function<void()>([z] {
+            double acc = 0;
+            for (double v : *z) acc += norm_cdf(v);
+            g_sink = acc;
+        });
+    }});
+    suite.push_back({"norm_cdf_batch", false, all, [](const BenchParams& p) {
+        auto z = std::make_shared<std::vector<double>>(p.n);
+        auto out = std::make_shared<std::vector<double>>(p.n);
+        for (size_t i = 0; i < p.n; ++i) (*z)[i] = -6.0 + 12.0 * (i + 0.5) / p.n;
+        return std::function<void()>([z, out] {
+            norm_cdf_batch(z->data(), out->data(), z->size());
+            g_sink = out->front();
+        });
+    }});
+    suite.push_back({"moments_of", false, all, [](const BenchParams& p) {
+        auto x = std::make_shared<std::vector<double>>();
+        std::vector<int> r;
+        makeNormal(p.n, 0.0, *x, r);
+        return std::function<void()>([x] { g_sink = moments_of(*x).m2; });
+    }});
+    suite.push_back({"grubbs_esd/k:10", false, all, [](const BenchParams& p) {
+        auto x = std::make_shared<std::vector<double>>();
+        std::vector<int> r;
+        makeNormal(p.n, 0.0, *x, r);
+        return std::function<void()>([x] { g_sink = grubbs_esd(*x, 10, 0.05, 0).steps.size(); });
+    }});
+    // Прореживание графика при смене масштаба (бюджет кадра - 16 мс)
+    for (bool scatter : {true, false}) {
+        suite.push_back({scatter ? "plot_lod/scatter" : "plot_lod/line", false, all, [scatter](const BenchParams& p) {
+            auto lod = plotLodBench(p.n, scatter);
+            return std::function<void()>([lod] {
+                std::vector<double> xs, ys;
+                lod->series.decimate(lod->view, xs, ys);
+                g_sink = static_cast<double>(xs.size());
+            });
+        }});
+    }
+
+    for (const MethodInfo& info : methodRegistry()) {
+        const std::string id = info.id;
+        // Методы с цензурой - MLE/MLS; критериям доля цензуры безразлична
+        const bool censored = id.rfind("MLE_", 0) == 0 || id.rfind("MLS_", 0) == 0;
+        AbstractMethod* (*create)() = info.create;
+        suite.push_back({"calculate/" + id, censored, all, [id, create](const BenchParams& p) {
+            auto data = std::make_shared<std::pair<std::vector<double>, std::vector<int>>>();
+            methodInput(id, p.n, p.cens, data->first, data->second);
+            std::shared_ptr<const AbstractMethod> method(create());
+            return std::function<void()>([data, method] {
+                g_sink = static_cast<double>(method->calculate(data->first, data->second, false).report.size());
+            });
+        }});
+    }
+    return suite;
+}
+
+static BenchRun runOne(const std::string& name, const BenchParams& p, const std::function<void()>& op, double minTime) {
+    op(); // прогрев: кеши, ленивые таблицы
+    size_t iters = 1;
+    for (;;) {
+        std::clock_t c0 = std::clock();
+        auto t0 = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iters; ++i) op();
+        double real = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        double cpu = static_cast<double>(std::clock() - c0) / CLOCKS_PER_SEC;
+        if (real >= minTime || iters >= (size_t(1) << 30)) {
+            return {name, p, iters, real * 1e9 / iters, cpu * 1e9 / iters};
+        }
+        // Как в Google Benchmark: следующий прогон с запасом до minTime
+        double grow = real > 0 ? std::min(10.0, 1.4 * minTime / real) : 10.0;
+        iters = static_cast<size_t>(std::max(static_cast<double>(iters) + 1, iters * grow));
+    }
+}
+
+static std::string runName(const BenchRun& r, bool usesCens) {
+    std::string s = r.name + "/n:" + std::to_string(r.params.n);
+    if (usesCens) {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "/cens:%g", r.params.cens);
+        s += buf;
+    }
+    return s;
+}
+
+// Строка для JSON: кавычки, обратная косая черта и управляющие символы
+// (путь к программе может содержать любые из них, например в Windows)
+static std::string jsonEscape(const std::string& v) {
+    std::string s;
+    for (char c : v) {
+        if (c == '"' || c == '\\') {
+            s += '\\';
+            s += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char buf[8];
+            std::snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned>(c));
+            s += buf;
+        } else {
+            s += c;
+        }
+    }
+    return s;
+}
+
+// false - файл не открылся или запись не удалась
+static bool writeJson(const std::string& path, const std::vector<BenchRun>& runs, const std::vector<bool>& usesCens,
+                      const char* argv0) {
+    std::ofstream out(path);
+    if (!out) return false;
+    char date[64];
+    std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+    out << "{\n  \"context\": {\n"
+        << "    \"date\": \"" << date << "\",\n"
+        << "    \"executable\": \"" << jsonEscape(argv0) << "\",\n"
+        << "    \"num_cpus\": " << default_thread_count() << ",\n"
+        << "    \"weibull_kernel\": \"" << weibull_kernel_name() << "\",\n"
+#ifdef NDEBUG
+        << "    \"library_build_type\": \"release\"\n"
+#else
+        << "    \"library_build_type\": \"debug\"\n"
+#endif
+        << "  },\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < runs.size(); ++i) {
+        const BenchRun& r = runs[i];
+        const std::string name = jsonEscape(runName(r, usesCens[i]));
+        char line[512];
+        std::snprintf(line, sizeof(line),
+                      "    {\"name\": \"%s\", \"run_name\": \"%s\", \"run_type\": \"iteration\", "
+                      "\"iterations\": %zu, \"real_time\": %.6g, \"cpu_time\": %.6g, \"time_unit\": \"ns\", "
+                      "\"items_per_second\": %.6g, \"n\": %zu, \"cens\": %g}%s\n",
+                      name.c_str(), name.c_str(), r.iterations, r.realNs, r.cpuNs,
+                      r.realNs > 0 ? r.params.n * 1e9 / r.realNs : 0.0, r.params.n, r.params.cens,
+                      i + 1 < runs.size() ? "," : "");
+        out << line;
+    }
+    out << "  ]\n}\n";
+    out.close();
+    return !out.fail();
+}
+
+static void printUsage() {
+    std::printf("Замеры производительности оценок и методов\n\n"
+                "Использование: Benchmark_Agamirov [опции]\n\n"
+                "  --filter S      только замеры, в имени которых есть S\n"
+                "  --max-n N       наибольший объем выборки (по умолчанию 1000000, до 10000000)\n"
+                "  --cens LIST     доли цензуры через запятую (по умолчанию 0,0.2,0.5)\n"
+                "  --min-time SEC  минимальное время замера (0.2)\n"
+                "  --json FILE     записать результаты в JSON (формат Google Benchmark)\n"
+                "  --list          только перечислить замеры\n"
+                "  --compare       сравнения со старыми реализациями (ядро Вейбулла, разбор .inp,\n"
+                "                  бутстреп, Уилкоксон, Шапиро-Уилк, Граббс (ESD), сводки групп,\n"
+                "                  попарные сравнения Тьюки / Геймса-Хауэлла,\n"
+                "                  точность norm_cdf/norm_ppf, neldermead против gradopt, кеш выборки);\n"
+                "                  код возврата 1, если параллельные оценки разошлись с последовательными\n"
+                "                  или потоковые - с оценками в памяти\n");
+}
+
+int main(int argc, char *argv[])
+{
+    // calculate/* меряет полный расчет; кеш включает только --compare
+    fitCache().setEnabled(false);
+
+    std::string filter, jsonPath;
+    size_t maxN = 1000000;
+    double minTime = 0.2;
+    std::vector<double> censList = {0.0, 0.2, 0.5};
+    bool list = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--filter" && hasValue) filter = argv[++i];
+        else if (arg == "--max-n" && hasValue) maxN = static_cast<size_t>(std::atoll(argv[++i]));
+        else if (arg == "--min-time" && hasValue) minTime = std::atof(argv[++i]);
+        else if (arg == "--json" && hasValue) jsonPath = argv[++i];
+        else if (arg == "--list") list = true;
+        else if (arg == "--cens" && hasValue) {
+            censList.clear();
+            std::string v = argv[++i];
+            for (size_t pos = 0; pos <= v.size();) {
+                size_t comma = v.find(',', pos);
+                if (comma == std::string::npos) comma = v.size();
+                censList.push_back(std::atof(v.substr(pos, comma - pos).c_str()));
+                pos = comma + 1;
+            }
+        } else if (arg == "--compare") {
+            benchWeibullKernel();
+            benchInpParser();
+            benchBootstrap();
+            benchRankSum();
+            benchShapiroWilk();
+            benchGrubbs();
+            benchGroupStats();
+            benchPostHoc();
+            benchNormalDist();
+            benchGradOpt();
+            benchFitCache();
+            bool ok = checkConcurrentFits();
+            ok = checkStreamingFits() && ok;
+            return ok ? 0 : 1;
+        } else {
+            printUsage();
+            return arg == "-h" || arg == "--help" ? 0 : 2;
+        }
+    }
+
+    std::vector<BenchRun> runs;
+    std::vector<bool> usesCens;
+    std::printf("%-52s %14s %14s %12s %14s\n", "Замер", "Время, ns", "CPU, ns", "Итераций", "элементов/с");
+    for (const BenchDef& def : benchSuite()) {
+        if (!filter.empty() && def.name.find(filter) == std::string::npos) continue;
+        for (size_t n = 10; n <= std::min(maxN, def.maxN); n *= 10) {
+            for (double cens : def.usesCens ? censList : std::vector<double>{0.0}) {
+                BenchParams p{n, cens};
+                BenchRun probe{def.name, p, 0, 0, 0};
+                if (list) { std::printf("%s\n", runName(probe, def.usesCens).c_str()); continue; }
+
+                BenchRun r = runOne(def.name, p, def.make(p), minTime);
+                runs.push_back(r);
+                usesCens.push_back(def.usesCens);
+                std::printf("%-52s %14.0f %14.0f %12zu %14.4g\n", runName(r, def.usesCens).c_str(), r.realNs, r.cpuNs,
+                            r.iterations, r.realNs > 0 ? n * 1e9 / r.realNs : 0.0);
+                std::fflush(stdout);
+            }
+        }
+    }
+
+    if (!jsonPath.empty() && !list && !writeJson(jsonPath, runs, usesCens, argv[0])) {
+        std::fprintf(stderr, "Не удалось записать %s\n", jsonPath.c_str());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,153 @@
+#include "binarysample.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const char kMagic[8] = {'L', 'A', 'B', 'S', 'M', 'P', '0', '1'};
+
+static uint64_t alignUp(uint64_t v, uint64_t a) { return (v + a - 1) / a * a; }
+
+bool convertInpToBinary(const std::string& inpPath, const std::string& smpPath, std::string& error) {
+    InpChunkReader reader;
+    if (!reader.open(inpPath, error)) return false;
+
+    std::ofstream out(smpPath, std::ios::binary | std::ios::trunc);
+    if (!out) { error = smpPath + ": не удалось открыть для записи"; return false; }
+
+    BinarySampleHeader h;
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, kMagic, sizeof(kMagic));
+    h.version = 1;
+    h.headerSize = sizeof(BinarySampleHeader);
+    h.timesOffset = alignUp(sizeof(BinarySampleHeader), 64);
+
+    // Заголовок дописывается в конце, когда известно n
+    std::vector<char> pad(static_cast<size_t>(h.timesOffset), 0);
+    out.write(pad.data(), static_cast<std::streamsize>(pad.size()));
+
+    std::vector<double> x;
+    std::vector<int> r;
+    std::vector<uint64_t> bits;
+    uint64_t n = 0;
+    while (reader.next(x, r, size_t(1) << 16)) {
+        out.write(reinterpret_cast<const char*>(x.data()), static_cast<std::streamsize>(x.size() * sizeof(double)));
+        for (size_t i = 0; i < r.size(); ++i, ++n) {
+            if ((n & 63) == 0) bits.push_back(0);
+            if (r[i] != 0) bits.back() |= uint64_t(1) << (n & 63);
+        }
+    }
+
+    h.n = n;
+    h.censOffset = alignUp(h.timesOffset + n * sizeof(double), 64);
+    h.fileSize = h.censOffset + bits.size() * sizeof(uint64_t);
+
+    std::vector<char> gap(static_cast<size_t>(h.censOffset - (h.timesOffset + n * sizeof(double))), 0);
+    out.write(gap.data(), static_cast<std::streamsize>(gap.size()));
+    out.write(reinterpret_cast<const char*>(bits.data()), static_cast<std::streamsize>(bits.size() * sizeof(uint64_t)));
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    if (!out) { error = smpPath + ": ошибка записи"; return false; }
+    return true;
+}
+
+MappedSample::~MappedSample() {
+    close();
+}
+
+// Столбец из count 8-байтовых слов по смещению offset целиком внутри
+// отображения и выровнен. Без умножения: n из поврежденного заголовка
+// может быть любым, и offset + n * 8 переполнился бы.
+static bool columnFits(uint64_t offset, uint64_t count, size_t size) {
+    if (offset % 8 != 0 || offset < sizeof(BinarySampleHeader) || offset > size) return false;
+    return count <= (size - offset) / 8;
+}
+
+bool MappedSample::open(const std::string& path, std::string& error) {
+    close();
+#ifdef _WIN32
+    HANDLE f = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (f == INVALID_HANDLE_VALUE) { error = path + ": не удалось открыть"; return false; }
+    LARGE_INTEGER sz;
+    GetFileSizeEx(f, &sz);
+    HANDLE m = CreateFileMappingA(f, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    void* p = m ? MapViewOfFile(m, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    fileHandle = f;
+    mappingHandle = m;
+    if (!p) { close(); error = path + ": не удалось отобразить в память"; return false; }
+    base = p;
+    mappedSize = static_cast<size_t>(sz.QuadPart);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) { error = path + ": не удалось открыть"; return false; }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(BinarySampleHeader))) {
+        ::close(fd);
+        error = path + ": файл слишком короткий";
+        return false;
+    }
+    void* p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // отображение остается действительным и после закрытия дескриптора
+    if (p == MAP_FAILED) { error = path + ": не удалось отобразить в память"; return false; }
+    base = p;
+    mappedSize = static_cast<size_t>(st.st_size);
+    madvise(base, mappedSize, MADV_SEQUENTIAL);
+#endif
+
+    const BinarySampleHeader* h = static_cast<const BinarySampleHeader*>(base);
+    if (mappedSize < sizeof(BinarySampleHeader) || std::memcmp(h->magic, kMagic, sizeof(kMagic)) != 0 || h->version != 1) {
+        close();
+        error = path + ": не файл выборки .smp";
+        return false;
+    }
+    if (h->fileSize > mappedSize || !columnFits(h->timesOffset, h->n, mappedSize) ||
+        !columnFits(h->censOffset, h->n / 64 + (h->n % 64 != 0), mappedSize)) {
+        close();
+        error = path + ": файл .smp поврежден (обрезан или неверные смещения)";
+        return false;
+    }
+
+    const char* bytes = static_cast<const char*>(base);
+    timesPtr = reinterpret_cast<const double*>(bytes + h->timesOffset);
+    censPtr = reinterpret_cast<const uint64_t*>(bytes + h->censOffset);
+    count = static_cast<size_t>(h->n);
+    return true;
+}
+
+void MappedSample::close() {
+#ifdef _WIN32
+    if (base) UnmapViewOfFile(base);
+    if (mappingHandle) CloseHandle(mappingHandle);
+    if (fileHandle) CloseHandle(fileHandle);
+    fileHandle = mappingHandle = nullptr;
+#else
+    if (base) munmap(base, mappedSize);
+#endif
+    base = nullptr;
+    mappedSize = 0;
+    timesPtr = nullptr;
+    censPtr = nullptr;
+    count = 0;
+}
+
+bool MappedChunkSource::next(std::vector<double>& x, std::vector<int>& r, size_t maxCount) {
+    x.clear();
+    r.clear();
+    DataView t = sample.times();
+    CensView c = sample.cens();
+    size_t end = std::min(t.size(), pos + maxCount);
+    for (; pos < end; ++pos) {
+        x.push_back(t[pos]);
+        r.push_back(c[pos]);
+    }
+    return !x.empty();
+}
@@ -0,0 +1,68 @@
+#ifndef BINARYSAMPLE_H
+#define BINARYSAMPLE_H
+
+#include "sampleview.h"
+#include "streamingfit.h"
+#include <cstdint>
+#include <string>
+
+// Бинарный столбцовый формат выборки (.smp), little-endian:
+//   заголовок 64 байта | n значений float64 (с выравниванием на 64) |
+//   признаки цензуры, упакованные по 64 в uint64 (бит 1 - цензурировано)
+struct BinarySampleHeader {
+    char magic[8];          // "LABSMP01"
+    uint32_t version;       // 1
+    uint32_t headerSize;    // sizeof(BinarySampleHeader)
+    uint64_t n;
+    uint64_t timesOffset;
+    uint64_t censOffset;
+    uint64_t fileSize;
+    uint8_t reserved[16];
+};
+static_assert(sizeof(BinarySampleHeader) == 64, "BinarySampleHeader должен занимать 64 байта");
+
+// Конвертер .inp -> .smp; .inp читается порциями (InpChunkReader), так что
+// память ограничена битами цензуры (n/8 байт), а не самой выборкой.
+bool convertInpToBinary(const std::string& inpPath, const std::string& smpPath, std::string& error);
+
+// Отображение .smp в память: view() отдает наработки и цензуру прямо из
+// страниц файла, без разбора и копирования. Представление живет, пока жив объект.
+class MappedSample {
+public:
+    MappedSample() {}
+    ~MappedSample();
+    MappedSample(const MappedSample&) = delete;
+    MappedSample& operator=(const MappedSample&) = delete;
+
+    bool open(const std::string& path, std::string& error);
+    void close();
+
+    DataView times() const { return DataView(timesPtr, count); }
+    CensView cens() const { return CensView::fromBits(censPtr, count); }
+    size_t size() const { return count; }
+
+private:
+    void* base = nullptr;
+    size_t mappedSize = 0;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+    const double* timesPtr = nullptr;
+    const uint64_t* censPtr = nullptr;
+    size_t count = 0;
+};
+
+// Порционный источник поверх отображенного файла для потоковых оценок
+class MappedChunkSource : public SampleChunkSource {
+public:
+    explicit MappedChunkSource(const MappedSample& s) : sample(s) {}
+    void rewind() override { pos = 0; }
+    bool next(std::vector<double>& x, std::vector<int>& r, size_t maxCount) override;
+
+private:
+    const MappedSample& sample;
+    size_t pos = 0;
+};
+
+#endif // BINARYSAMPLE_H
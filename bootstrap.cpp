@@ -0,0 +1,138 @@
+#include "bootstrap.h"
+#include "analysis.h"
+#include "parallel.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <random>
+
+namespace {
+
+// xoshiro256** с затравкой через splitmix64: дешевый старт для каждого блока
+struct BootRng {
+    typedef uint64_t result_type;
+    uint64_t s[4];
+
+    explicit BootRng(uint64_t seed) {
+        for (uint64_t& w : s) {
+            seed += 0x9e3779b97f4a7c15ULL;
+            uint64_t z = seed;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            w = z ^ (z >> 31);
+        }
+    }
+    static constexpr uint64_t min() { return 0; }
+    static constexpr uint64_t max() { return ~uint64_t(0); }
+    static uint64_t rotl(uint64_t v, int k) { return (v << k) | (v >> (64 - k)); }
+    uint64_t operator()() {
+        uint64_t out = rotl(s[1] * 5, 7) * 9, t = s[1] << 17;
+        s[2] ^= s[0]; s[3] ^= s[1]; s[1] ^= s[2]; s[0] ^= s[3];
+        s[2] ^= t; s[3] = rotl(s[3], 45);
+        return out;
+    }
+    // (0, 1]: логарифм от нуля не берется
+    double uniform() { return (static_cast<double>((*this)() >> 11) + 1.0) * 0x1.0p-53; }
+    size_t index(size_t n) { return static_cast<size_t>(uniform() * static_cast<double>(n)) % n; }
+};
+
+struct Scratch {
+    std::vector<double> x;
+    std::vector<int> r;
+    FitContext ctx{DataView(), CensView()};
+    std::normal_distribution<double> normal;
+};
+
+const size_t kBlock = 64;
+
+// Квантиль выборки с линейной интерполяцией (тип 7); v переставляется
+double sampleQuantile(std::vector<double>& v, double q) {
+    double h = q * static_cast<double>(v.size() - 1);
+    size_t lo = static_cast<size_t>(h);
+    std::nth_element(v.begin(), v.begin() + lo, v.end());
+    double a = v[lo];
+    if (lo + 1 >= v.size()) return a;
+    double b = *std::min_element(v.begin() + lo + 1, v.end());
+    return a + (h - lo) * (b - a);
+}
+
+} // namespace
+
+bool bootstrap_quantiles(DataView x, CensView r, double p1, double p2, const std::vector<double>& probs,
+                         const BootstrapOptions& opt, BootstrapResult& res) {
+    res = BootstrapResult();
+    const size_t n = x.size(), B = opt.resamples, P = probs.size();
+    if (n < 2 || B < 2 || P == 0 || !(p2 > 0)) return false;
+    const bool weibull = (opt.model == BootstrapModel::Weibull);
+
+    // Квантиль стандартного закона: Xp = c * exp(tp / b)  или  a + sigma * zp
+    std::vector<double> tp(P);
+    for (size_t k = 0; k < P; ++k) tp[k] = weibull ? std::log(-std::log(1.0 - probs[k])) : norm_ppf(probs[k]);
+
+    const unsigned threads = opt.threads ? opt.threads : default_thread_count();
+    std::vector<Scratch> scratch(threads);
+    std::vector<double> xp(P * B, std::numeric_limits<double>::quiet_NaN());
+    const size_t blocks = (B + kBlock - 1) / kBlock;
+
+    auto t0 = std::chrono::steady_clock::now();
+    parallel_for(blocks, threads, [&](size_t blk, unsigned w) {
+        Scratch& s = scratch[w];
+        s.x.resize(n);
+        s.r.resize(n);
+        BootRng rng(opt.seed ^ (0x632be59bd9b4e019ULL * (blk + 1)));
+
+        for (size_t i = blk * kBlock; i < std::min(B, (blk + 1) * kBlock); ++i) {
+            if (opt.kind == BootstrapKind::Nonparametric) {
+                for (size_t j = 0; j < n; ++j) {
+                    size_t k = rng.index(n);
+                    s.x[j] = x[k];
+                    s.r[j] = r[k];
+                }
+            } else {
+                for (size_t j = 0; j < n; ++j) {
+                    double t = weibull ? p1 * std::pow(-std::log(rng.uniform()), 1.0 / p2)
+                                       : p1 + p2 * s.normal(rng);
+                    bool cut = r[j] != 0 && t > x[j];
+                    s.x[j] = cut ? x[j] : t;
+                    s.r[j] = cut ? 1 : 0;
+                }
+            }
+
+            s.ctx.reset(s.x, s.r);
+            double q1, q2;
+            if (weibull) {
+                // Старт Ньютона - исходная оценка формы: без сортировки в стартовой регрессии
+                auto est = weibull_mle_2par(s.ctx, p2);
+                if (!(std::isfinite(est.first) && std::isfinite(est.second)) || est.first <= 0 || est.second <= 0)
+                    est = weibull_regression_fallback(s.ctx);
+                q1 = est.first; q2 = est.second;
+            } else {
+                auto est = normal_mle_2par(s.ctx);
+                q1 = est.first; q2 = est.second;
+            }
+            if (!(std::isfinite(q1) && std::isfinite(q2)) || q2 <= 0) continue;
+
+            for (size_t k = 0; k < P; ++k)
+                xp[k * B + i] = weibull ? q1 * std::exp(tp[k] / q2) : q1 + q2 * tp[k];
+        }
+    });
+
+    const double alpha = 1.0 - opt.beta;
+    std::vector<double> col;
+    res.low.resize(P);
+    res.up.resize(P);
+    for (size_t k = 0; k < P; ++k) {
+        col.clear();
+        for (size_t i = 0; i < B; ++i) {
+            double v = xp[k * B + i];
+            if (std::isfinite(v)) col.push_back(v);
+        }
+        if (k == 0) res.ok = col.size();
+        if (col.size() < 2) return false;
+        res.low[k] = sampleQuantile(col, alpha / 2.0);
+        res.up[k] = sampleQuantile(col, 1.0 - alpha / 2.0);
+    }
+    res.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return true;
+}
@@ -0,0 +1,38 @@
+#ifndef BOOTSTRAP_H
+#define BOOTSTRAP_H
+
+#include "sampleview.h"
+#include <cstdint>
+#include <vector>
+
+enum class BootstrapModel { Weibull, Normal };
+
+// Параметрический: новые наработки из подобранного закона при той же схеме
+// цензуры (цензурированное изделие снято в свой момент x_i, если не отказало
+// раньше). Непараметрический: пары (x_i, r_i) с возвращением.
+enum class BootstrapKind { Parametric, Nonparametric };
+
+struct BootstrapOptions {
+    BootstrapModel model = BootstrapModel::Weibull;
+    BootstrapKind kind = BootstrapKind::Parametric;
+    size_t resamples = 10000;
+    double beta = 0.95;          // доверительная вероятность
+    unsigned threads = 0;        // 0 - по числу ядер
+    uint64_t seed = 20240917;
+};
+
+// Процентильные интервалы квантилей Xp по вероятностям probs
+struct BootstrapResult {
+    std::vector<double> low, up;
+    size_t ok = 0;       // успешных переоценок (остальные отброшены)
+    double seconds = 0;
+};
+
+// p1, p2 - оценки по исходной выборке: (c, b) для Вейбулла или (a, sigma).
+// Переоценки идут блоками по всем ядрам; у каждого блока свой поток
+// случайных чисел от (seed, номер блока), поэтому результат не зависит
+// от числа потоков. Рабочие буферы заводятся по одному на поток.
+bool bootstrap_quantiles(DataView x, CensView r, double p1, double p2, const std::vector<double>& probs,
+                         const BootstrapOptions& opt, BootstrapResult& res);
+
+#endif // BOOTSTRAP_H
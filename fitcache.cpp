@@ -0,0 +1,101 @@
+#include "fitcache.h"
+#include <cstring>
+
+namespace {
+
+uint64_t rotl(uint64_t v, int k) { return (v << k) | (v >> (64 - k)); }
+
+uint64_t finish(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    return h ^ (h >> 33);
+}
+
+} // namespace
+
+SampleKey sample_key(DataView x, CensView r) {
+    SampleKey k;
+    k.n = x.size();
+    uint64_t a = 0x9e3779b97f4a7c15ULL ^ k.n, b = 0xc2b2ae3d27d4eb4fULL + k.n;
+    for (size_t i = 0; i < x.size(); ++i) {
+        uint64_t v;
+        std::memcpy(&v, &x[i], sizeof v);
+        v += static_cast<uint64_t>(r[i] + 1) * 0x165667b19e3779f9ULL;
+        a = rotl((a ^ v) * 0x9e3779b97f4a7c15ULL, 29);
+        b = rotl(b + v * 0xc2b2ae3d27d4eb4fULL, 31) * 0x27d4eb2f165667c5ULL;
+    }
+    k.h1 = finish(a);
+    k.h2 = finish(b ^ a);
+    return k;
+}
+
+const std::vector<size_t>& SampleCache::sortedOrder(DataView x, CensView r) {
+    std::call_once(orderOnce, [&] {
+        km_sort_order(x, r, order);
+        used += order.size() * sizeof(size_t);
+    });
+    return order;
+}
+
+const EmpiricalKM& SampleCache::km(DataView x, CensView r) {
+    std::call_once(kmOnce, [&] {
+        const std::vector<size_t>& o = sortedOrder(x, r);
+        kmData = kaplan_meier_sorted(x, r, o.empty() ? nullptr : o.data());
+        used += (kmData.x_sorted.size() + kmData.F_emp.size()) * sizeof(double);
+    });
+    return kmData;
+}
+
+bool SampleCache::find(const std::string& name, FitRecord& rec) {
+    std::lock_guard<std::mutex> lock(fitsMutex);
+    auto it = fits.find(name);
+    if (it == fits.end()) return false;
+    rec = it->second;
+    return true;
+}
+
+void SampleCache::store(const std::string& name, const FitRecord& rec) {
+    std::lock_guard<std::mutex> lock(fitsMutex);
+    fits.emplace(name, rec);
+}
+
+FitCache::FitCache(size_t capacity_, size_t maxBytes_) : capacity(capacity_), maxBytes(maxBytes_) {}
+
+std::shared_ptr<SampleCache> FitCache::lookup(DataView x, CensView r) {
+    if (!enabled) return nullptr;
+    SampleKey key = sample_key(x, r);
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto it = entries.begin(); it != entries.end(); ++it) {
+        if (!((*it)->key == key)) continue;
+        ++hitCount;
+        entries.splice(entries.begin(), entries, it);
+        return entries.front();
+    }
+    ++missCount;
+    entries.push_front(std::make_shared<SampleCache>(key));
+
+    // Вытеснение с конца; запись, которой еще пользуются, живет до конца расчета
+    size_t total = 0, kept = 0;
+    for (auto it = entries.begin(); it != entries.end();) {
+        total += (*it)->bytes();
+        if (kept > 0 && (kept >= capacity || total > maxBytes)) {
+            it = entries.erase(it);
+            continue;
+        }
+        ++kept;
+        ++it;
+    }
+    return entries.front();
+}
+
+void FitCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+}
+
+FitCache& fitCache() {
+    static FitCache cache;
+    return cache;
+}
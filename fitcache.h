@@ -0,0 +1,80 @@
+#ifndef FITCACHE_H
+#define FITCACHE_H
+
+#include "analysis.h"
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+// Содержимое выборки: два независимых 64-битных хеша наработок и признаков
+// цензуры плюс объем. Равные ключи - та же выборка (вероятность совпадения
+// разных выборок ~2^-128).
+struct SampleKey {
+    uint64_t h1 = 0, h2 = 0;
+    size_t n = 0;
+    bool operator==(const SampleKey& o) const { return h1 == o.h1 && h2 == o.h2 && n == o.n; }
+};
+
+SampleKey sample_key(DataView x, CensView r);
+
+// Производные данные одной выборки, общие для всех методов. Порядок и КМ
+// считаются один раз первым обратившимся потоком; оценки хранятся по
+// ключам методов (FitContext::memo). Сама выборка не хранится: x, r
+// передает вызывающий.
+class SampleCache {
+public:
+    explicit SampleCache(const SampleKey& k) : key(k) {}
+
+    const SampleKey key;
+
+    // Пустой порядок - выборка уже упорядочена (как у FitContext)
+    const std::vector<size_t>& sortedOrder(DataView x, CensView r);
+    const EmpiricalKM& km(DataView x, CensView r);
+    // Оценка метода name, если уже запомнена
+    bool find(const std::string& name, FitRecord& rec);
+    // При гонке двух потоков за один ключ остается первая запись (они равны)
+    void store(const std::string& name, const FitRecord& rec);
+
+    // Занятая память (растет по мере расчета частей)
+    size_t bytes() const { return used.load(std::memory_order_relaxed); }
+
+private:
+    std::once_flag orderOnce, kmOnce;
+    std::vector<size_t> order;
+    EmpiricalKM kmData;
+    std::mutex fitsMutex;
+    std::map<std::string, FitRecord> fits;
+    std::atomic<size_t> used{0};
+};
+
+// Выборки в порядке последнего обращения. Вытесняются самые старые, когда
+// записей больше capacity или они занимают больше maxBytes.
+class FitCache {
+public:
+    explicit FitCache(size_t capacity = 8, size_t maxBytes = size_t(256) << 20);
+
+    // nullptr, если кеш выключен: FitContext тогда считает все сам
+    std::shared_ptr<SampleCache> lookup(DataView x, CensView r);
+    void clear();
+    // Пакетный режим и замеры выключают кеш: там выборки не повторяются
+    void setEnabled(bool on) { enabled = on; }
+
+    size_t hits() const { return hitCount; }
+    size_t misses() const { return missCount; }
+
+private:
+    std::mutex mutex;
+    std::list<std::shared_ptr<SampleCache>> entries;   // в начале - последняя
+    size_t capacity, maxBytes;
+    std::atomic<size_t> hitCount{0}, missCount{0};
+    std::atomic<bool> enabled{true};
+};
+
+// Общий кеш методов (MethodRegistry, MainWindow, пакетный режим)
+FitCache& fitCache();
+
+#endif // FITCACHE_H
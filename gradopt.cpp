@@ -0,0 +1,105 @@
+#include "gradopt.h"
+
+namespace {
+
+// Разложение Холецкого A + shift*I = L L' (n мало, память снаружи).
+// false - матрица не положительно определена.
+bool cholesky(const double* A, size_t n, double shift, double* L) {
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j <= i; ++j) {
+            double s = A[i * n + j] + (i == j ? shift : 0.0);
+            for (size_t k = 0; k < j; ++k) s -= L[i * n + k] * L[j * n + k];
+            if (i == j) {
+                if (!(s > 0)) return false;
+                L[i * n + i] = std::sqrt(s);
+            } else {
+                L[i * n + j] = s / L[j * n + j];
+            }
+        }
+    }
+    return true;
+}
+
+// L L' p = -g, возвращает ||p||
+double cholesky_solve(const double* L, const double* g, size_t n, double* p) {
+    for (size_t i = 0; i < n; ++i) {
+        double s = -g[i];
+        for (size_t k = 0; k < i; ++k) s -= L[i * n + k] * p[k];
+        p[i] = s / L[i * n + i];
+    }
+    double norm = 0;
+    for (size_t i = n; i-- > 0;) {
+        double s = p[i];
+        for (size_t k = i + 1; k < n; ++k) s -= L[k * n + i] * p[k];
+        p[i] = s / L[i * n + i];
+        norm += p[i] * p[i];
+    }
+    return std::sqrt(norm);
+}
+
+} // namespace
+
+double trust_region_step(const double* H, const double* g, size_t n, double radius, double* p) {
+    std::vector<double> L(n * n);
+    double gnorm = 0, hnorm = 0;
+    for (size_t i = 0; i < n; ++i) gnorm += g[i] * g[i];
+    for (size_t i = 0; i < n * n; ++i) hnorm += H[i] * H[i];
+    gnorm = std::sqrt(gnorm);
+    hnorm = std::sqrt(hnorm);
+
+    // Ньютоновский шаг, если он внутри области
+    if (!(cholesky(H, n, 0.0, L.data()) && cholesky_solve(L.data(), g, n, p) <= radius)) {
+        // Иначе lambda делением пополам до ||p|| в [0.9, 1] * radius.
+        // При lambda = ||H|| + ||g||/radius матрица положительно определена
+        // и ||p|| <= radius, так что верхняя граница всегда допустима.
+        double lo = 0, hi = hnorm + gnorm / radius;
+        cholesky(H, n, hi, L.data());
+        cholesky_solve(L.data(), g, n, p);
+        std::vector<double> q(n);
+        for (int it = 0; it < 100 && hi - lo > 1e-12 * hi; ++it) {
+            double mid = 0.5 * (lo + hi);
+            if (!cholesky(H, n, mid, L.data())) { lo = mid; continue; }
+            double norm = cholesky_solve(L.data(), g, n, q.data());
+            if (norm > radius) { lo = mid; continue; }
+            hi = mid;
+            std::copy(q.begin(), q.end(), p);
+            if (norm >= 0.9 * radius) break;
+        }
+    }
+
+    double pred = 0;
+    for (size_t i = 0; i < n; ++i) {
+        double hp = 0;
+        for (size_t j = 0; j < n; ++j) hp += H[i * n + j] * p[j];
+        pred -= g[i] * p[i] + 0.5 * p[i] * hp;
+    }
+    return pred;
+}
+
+void lbfgs_direction(const double* g, const double* S, const double* Y, const double* rho,
+                     size_t n, size_t memory, size_t count, size_t newest, double* d) {
+    double alpha[64];
+    count = std::min<size_t>(count, 64);
+    for (size_t i = 0; i < n; ++i) d[i] = -g[i];
+    if (count == 0) return;
+
+    for (size_t k = 0; k < count; ++k) {
+        size_t j = (newest + memory - k) % memory;
+        double a = 0;
+        for (size_t i = 0; i < n; ++i) a += S[j * n + i] * d[i];
+        alpha[k] = a * rho[j];
+        for (size_t i = 0; i < n; ++i) d[i] -= alpha[k] * Y[j * n + i];
+    }
+    // Начальная матрица gamma*I по последней паре
+    double yy = 0;
+    for (size_t i = 0; i < n; ++i) yy += Y[newest * n + i] * Y[newest * n + i];
+    double gamma = 1.0 / (rho[newest] * yy);
+    for (size_t i = 0; i < n; ++i) d[i] *= gamma;
+    for (size_t k = count; k-- > 0;) {
+        size_t j = (newest + memory - k) % memory;
+        double b = 0;
+        for (size_t i = 0; i < n; ++i) b += Y[j * n + i] * d[i];
+        b *= rho[j];
+        for (size_t i = 0; i < n; ++i) d[i] += (alpha[k] - b) * S[j * n + i];
+    }
+}
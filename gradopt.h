@@ -0,0 +1,185 @@
+#ifndef GRADOPT_H
+#define GRADOPT_H
+
+#include "autodiff.h"
+#include "sampleview.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+// Градиентные методы для гладких правдоподобий с 2-4 параметрами. Целевая
+// функция (минус логарифм правдоподобия) задается один раз шаблоном:
+//     auto f = [&](const auto& p) { ... return nll; };   // p[i] - тип T
+// и вызывается с double, ad::Grad<N> и ad::Hess<N>, так что градиент и
+// гессиан точные, без разностных схем. Вне области определения f должна
+// возвращать большое конечное значение (как weibull_neg_loglik).
+
+struct GradOptOptions {
+    int maxIterations = 200;
+    double gtol = 1e-9;          // max|g_i| <= gtol * max(1, |f|)
+    double xtol = 1e-12;         // относительный шаг
+    int memory = 6;              // пар (s, y) в L-BFGS
+};
+
+struct GradOptResult {
+    std::vector<double> x;
+    double fx = 0;
+    std::vector<double> grad;
+    std::vector<double> hessian; // N*N по строкам, только у доверительной области
+    int iterations = 0;
+    long evaluations = 0;        // вычислений f (любого порядка)
+    bool converged = false;
+};
+
+// Шаг доверительной области: (H + lambda I) p = -g с lambda >= 0, ||p|| <= radius.
+// Возвращает предсказанное квадратичной моделью уменьшение f.
+double trust_region_step(const double* H, const double* g, size_t n, double radius, double* p);
+
+// Направление L-BFGS двухпетлевой рекурсией: d = -H_k g по count последним
+// парам в кольцевых буферах S, Y (memory строк по n), newest - индекс последней.
+void lbfgs_direction(const double* g, const double* S, const double* Y, const double* rho,
+                     size_t n, size_t memory, size_t count, size_t newest, double* d);
+
+namespace gradopt_detail {
+
+inline double max_abs(const double* v, size_t n) {
+    double m = 0;
+    for (size_t i = 0; i < n; ++i) m = std::max(m, std::abs(v[i]));
+    return m;
+}
+
+template <int N, class F>
+double value(const F& f, const double* x) {
+    std::array<double, N> p;
+    std::copy(x, x + N, p.begin());
+    return f(p);
+}
+
+} // namespace gradopt_detail
+
+// L-BFGS с возвратным поиском по Армихо. Одно вычисление f на Grad<N>
+// на каждую пробную точку; пары с s'y <= 0 не запоминаются.
+template <int N, class F>
+GradOptResult lbfgs_minimize(const F& f, DataView x0, const GradOptOptions& opt = GradOptOptions()) {
+    using gradopt_detail::max_abs;
+    const size_t m = static_cast<size_t>(std::max(1, opt.memory));
+    GradOptResult res;
+    std::array<double, N> x, g, d, xt, gt;
+    std::vector<double> S(m * N), Y(m * N), rho(m);
+    size_t count = 0, newest = 0;
+    std::copy(x0.begin(), x0.begin() + N, x.begin());
+
+    double fx = ad::value_gradient<N>(f, x.data(), g.data());
+    ++res.evaluations;
+    while (res.iterations < opt.maxIterations) {
+        if (max_abs(g.data(), N) <= opt.gtol * std::max(1.0, std::abs(fx))) { res.converged = true; break; }
+        ++res.iterations;
+
+        lbfgs_direction(g.data(), S.data(), Y.data(), rho.data(), N, m, count, newest, d.data());
+        double slope = 0;
+        for (int i = 0; i < N; ++i) slope += g[i] * d[i];
+        if (!(slope < 0)) {
+            // Направление испорчено - сброс памяти, антиградиент
+            count = 0;
+            for (int i = 0; i < N; ++i) d[i] = -g[i];
+            slope = 0;
+            for (int i = 0; i < N; ++i) slope -= g[i] * g[i];
+        }
+        // Первый шаг без памяти масштабируется, чтобы не выскочить из области
+        double t = count ? 1.0 : std::min(1.0, 0.1 * std::max(1.0, max_abs(x.data(), N)) / max_abs(d.data(), N));
+
+        double ft = 0;
+        bool accepted = false;
+        for (int k = 0; k < 60; ++k) {
+            for (int i = 0; i < N; ++i) xt[i] = x[i] + t * d[i];
+            ft = ad::value_gradient<N>(f, xt.data(), gt.data());
+            ++res.evaluations;
+            if (std::isfinite(ft) && ft <= fx + 1e-4 * t * slope) { accepted = true; break; }
+            t *= 0.5;
+        }
+        if (!accepted) break;
+
+        size_t slot = count ? (newest + 1) % m : 0;
+        double sy = 0, step = 0;
+        for (int i = 0; i < N; ++i) {
+            S[slot * N + i] = xt[i] - x[i];
+            Y[slot * N + i] = gt[i] - g[i];
+            sy += S[slot * N + i] * Y[slot * N + i];
+            step = std::max(step, std::abs(S[slot * N + i]) / std::max(1.0, std::abs(x[i])));
+        }
+        if (sy > 1e-12 * std::max(1.0, std::abs(fx))) {
+            rho[slot] = 1.0 / sy;
+            newest = slot;
+            count = std::min(count + 1, m);
+        }
+        x = xt; g = gt; fx = ft;
+        if (step < opt.xtol) { res.converged = true; break; }
+    }
+
+    res.x.assign(x.begin(), x.end());
+    res.grad.assign(g.begin(), g.end());
+    res.fx = fx;
+    return res;
+}
+
+// Ньютон с доверительной областью на точном гессиане: каждая принятая точка
+// стоит одного вызова f на Hess<N>, отвергнутая - одного вызова на double.
+// Невыпуклые участки (гессиан не положительно определен) проходятся сдвигом
+// lambda, поэтому метод не требует хорошего начального приближения.
+template <int N, class F>
+GradOptResult trust_region_minimize(const F& f, DataView x0, const GradOptOptions& opt = GradOptOptions()) {
+    using gradopt_detail::max_abs;
+    GradOptResult res;
+    std::array<double, N> x, g, p, xt;
+    std::array<double, N * N> H;
+    std::copy(x0.begin(), x0.begin() + N, x.begin());
+
+    double fx = ad::value_hessian<N>(f, x.data(), g.data(), H.data());
+    ++res.evaluations;
+    double radius = std::max(1.0, max_abs(x.data(), N));
+    while (res.iterations < opt.maxIterations) {
+        if (max_abs(g.data(), N) <= opt.gtol * std::max(1.0, std::abs(fx))) { res.converged = true; break; }
+        ++res.iterations;
+
+        double pred = trust_region_step(H.data(), g.data(), N, radius, p.data());
+        double pnorm = 0, step = 0;
+        for (int i = 0; i < N; ++i) {
+            xt[i] = x[i] + p[i];
+            pnorm += p[i] * p[i];
+            step = std::max(step, std::abs(p[i]) / std::max(1.0, std::abs(x[i])));
+        }
+        pnorm = std::sqrt(pnorm);
+        if (step < opt.xtol) { res.converged = pnorm < 0.99 * radius; break; }
+        if (!(pred > 0)) break;
+        // Уменьшение ниже ошибок округления f: сравнивать значения бесполезно,
+        // последний ньютоновский шаг принимается без проверки
+        if (pred < 1e-15 * std::max(1.0, std::abs(fx))) {
+            x = xt;
+            fx = ad::value_hessian<N>(f, x.data(), g.data(), H.data());
+            ++res.evaluations;
+            res.converged = true;
+            break;
+        }
+
+        double ft = gradopt_detail::value<N>(f, xt.data());
+        ++res.evaluations;
+        double ratio = std::isfinite(ft) ? (fx - ft) / pred : -1.0;
+        if (ratio < 0.25) radius = 0.25 * pnorm;
+        else if (ratio > 0.75 && pnorm > 0.99 * radius) radius *= 2.0;
+
+        if (ratio > 1e-4) {
+            x = xt;
+            fx = ad::value_hessian<N>(f, x.data(), g.data(), H.data());
+            ++res.evaluations;
+        }
+    }
+
+    res.x.assign(x.begin(), x.end());
+    res.grad.assign(g.begin(), g.end());
+    res.hessian.assign(H.begin(), H.end());
+    res.fx = fx;
+    return res;
+}
+
+#endif // GRADOPT_H
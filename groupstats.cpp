@@ -0,0 +1,207 @@
+#include "groupstats.h"
+#include "parallel.h"
+#include "radixsort.h"
+#include "tukey.h"
+#include <boost/math/distributions/fisher_f.hpp>
+#include <boost/math/distributions/students_t.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+static const size_t kBlock = 4096;
+static const size_t kParallelMin = size_t(1) << 20;
+
+void Moments::merge(const Moments& o) {
+    if (o.n == 0) return;
+    if (n == 0) { *this = o; return; }
+    double total = n + o.n;
+    double d = o.mean - mean;
+    mean += d * (o.n / total);
+    m2 += o.m2 + d * d * (n * o.n / total);
+    n = total;
+}
+
+// Блок в два прохода: среднее, затем отклонения от него
+static Moments blockMoments(const double* x, size_t len) {
+    Moments m;
+    if (len == 0) return m;
+    double sum = 0;
+    for (size_t i = 0; i < len; ++i) sum += x[i];
+    double mean = sum / len;
+    double sq = 0, corr = 0;
+    for (size_t i = 0; i < len; ++i) {
+        double d = x[i] - mean;
+        sq += d * d;
+        corr += d;
+    }
+    // Поправка на ошибку округления среднего
+    m.n = static_cast<double>(len);
+    m.mean = mean + corr / len;
+    m.m2 = sq - corr * corr / len;
+    return m;
+}
+
+static Moments rangeMoments(const double* x, size_t len) {
+    Moments m;
+    for (size_t b = 0; b < len; b += kBlock) m.merge(blockMoments(x + b, std::min(kBlock, len - b)));
+    return m;
+}
+
+Moments moments_of(DataView x, unsigned threads) {
+    const size_t n = x.size();
+    unsigned t = threads ? threads : radix_sort_threads();
+    if (t == 0) t = default_thread_count();
+    if (n < kParallelMin || t <= 1) return rangeMoments(x.data(), n);
+
+    // Сводки блоков пишутся параллельно, а объединяются в том же порядке,
+    // что и в одном потоке - результат совпадает до бита
+    const size_t blocks = (n + kBlock - 1) / kBlock;
+    std::vector<Moments> partial(blocks);
+    parallel_for(t, t, [&](size_t i, unsigned) {
+        for (size_t b = blocks * i / t; b < blocks * (i + 1) / t; ++b)
+            partial[b] = blockMoments(x.data() + b * kBlock, std::min(kBlock, n - b * kBlock));
+    });
+    Moments m;
+    for (const Moments& p : partial) m.merge(p);
+    return m;
+}
+
+static double fUpper(double f, double df1, double df2) {
+    try {
+        if (!(std::isfinite(f) && df1 > 0 && df2 > 0)) return std::numeric_limits<double>::quiet_NaN();
+        boost::math::fisher_f_distribution<double> dist(df1, df2);
+        return boost::math::cdf(boost::math::complement(dist, std::max(f, 0.0)));
+    } catch (...) { return std::numeric_limits<double>::quiet_NaN(); }
+}
+
+static double tTwoSided(double t, double df) {
+    try {
+        if (!(std::isfinite(t) && df > 0)) return std::numeric_limits<double>::quiet_NaN();
+        boost::math::students_t_distribution<double> dist(df);
+        return 2.0 * boost::math::cdf(boost::math::complement(dist, std::abs(t)));
+    } catch (...) { return std::numeric_limits<double>::quiet_NaN(); }
+}
+
+OneWayAnova one_way_anova(const std::vector<Moments>& groups) {
+    OneWayAnova res;
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    const double k = static_cast<double>(groups.size());
+    double N = 0, sum = 0;
+    for (const Moments& g : groups) { N += g.n; sum += g.n * g.mean; }
+    if (k < 2 || N <= k) return res;
+    res.grandMean = sum / N;
+
+    double bfDen = 0;
+    for (const Moments& g : groups) {
+        res.ssBetween += g.n * (g.mean - res.grandMean) * (g.mean - res.grandMean);
+        res.ssWithin += g.m2;
+        bfDen += (1.0 - g.n / N) * g.variance();
+    }
+    res.classic.df1 = k - 1;
+    res.classic.df2 = N - k;
+    res.classic.f = (res.ssBetween / res.classic.df1) / (res.ssWithin / res.classic.df2);
+    res.classic.p = fUpper(res.classic.f, res.classic.df1, res.classic.df2);
+
+    // Уэлч и Браун-Форсайт требуют n_i >= 2 и s_i > 0 в каждой группе
+    bool regular = true;
+    for (const Moments& g : groups) regular = regular && g.n >= 2 && g.variance() > 0;
+    if (!regular) {
+        res.welch.f = res.brownForsythe.f = nan;
+        res.welch.p = res.brownForsythe.p = nan;
+        return res;
+    }
+
+    double W = 0, wm = 0;
+    for (const Moments& g : groups) { double w = g.n / g.variance(); W += w; wm += w * g.mean; }
+    double mw = wm / W, a = 0, tmp = 0;
+    for (const Moments& g : groups) {
+        double w = g.n / g.variance();
+        a += w * (g.mean - mw) * (g.mean - mw);
+        tmp += (1.0 - w / W) * (1.0 - w / W) / (g.n - 1.0);
+    }
+    res.welch.df1 = k - 1;
+    res.welch.df2 = (k * k - 1.0) / (3.0 * tmp);
+    res.welch.f = (a / (k - 1.0)) / (1.0 + 2.0 * (k - 2.0) / (k * k - 1.0) * tmp);
+    res.welch.p = fUpper(res.welch.f, res.welch.df1, res.welch.df2);
+
+    double c2 = 0;
+    for (const Moments& g : groups) {
+        double c = (1.0 - g.n / N) * g.variance() / bfDen;
+        c2 += c * c / (g.n - 1.0);
+    }
+    res.brownForsythe.df1 = k - 1;
+    res.brownForsythe.df2 = 1.0 / c2;
+    res.brownForsythe.f = res.ssBetween / bfDen;
+    res.brownForsythe.p = fUpper(res.brownForsythe.f, res.brownForsythe.df1, res.brownForsythe.df2);
+    return res;
+}
+
+TwoSampleTests two_sample_tests(const Moments& a, const Moments& b) {
+    TwoSampleTests res;
+    double va = a.variance(), vb = b.variance();
+    res.firstLarger = va >= vb;
+    res.variance.f = res.firstLarger ? va / vb : vb / va;
+    res.variance.df1 = (res.firstLarger ? a.n : b.n) - 1;
+    res.variance.df2 = (res.firstLarger ? b.n : a.n) - 1;
+    res.variance.p = fUpper(res.variance.f, res.variance.df1, res.variance.df2);
+
+    double diff = a.mean - b.mean;
+    res.dfPooled = a.n + b.n - 2;
+    double sp = std::sqrt((a.m2 + b.m2) / res.dfPooled);
+    res.tPooled = diff / (sp * std::sqrt(1.0 / a.n + 1.0 / b.n));
+    res.pPooled = tTwoSided(res.tPooled, res.dfPooled);
+
+    double wa = va / a.n, wb = vb / b.n;
+    res.tWelch = diff / std::sqrt(wa + wb);
+    res.dfWelch = (wa + wb) * (wa + wb) / (wa * wa / (a.n - 1) + wb * wb / (b.n - 1));
+    res.pWelch = tTwoSided(res.tWelch, res.dfWelch);
+    return res;
+}
+
+PostHoc post_hoc(const std::vector<Moments>& groups, double alpha, unsigned threads) {
+    PostHoc res;
+    res.alpha = alpha;
+    const int k = static_cast<int>(groups.size());
+    double N = 0, ssw = 0;
+    for (const Moments& g : groups) { N += g.n; ssw += g.m2; }
+    if (k < 2 || N <= k) return res;
+    res.df = N - k;
+    const double msw = ssw / res.df;
+
+    auto dist = studentized_range(k);
+    auto crit = tukey_critical_table(alpha, k);
+    res.qCrit = tukey_critical(alpha, k, res.df);
+
+    res.pairs.resize(static_cast<size_t>(k) * (k - 1) / 2);
+    unsigned t = threads ? threads : radix_sort_threads();
+    if (res.pairs.size() < 256) t = 1;
+    // Строка i - пары (i, i+1..k-1); строки разной длины раздаются динамически
+    parallel_for(static_cast<size_t>(k - 1), t, [&](size_t row, unsigned) {
+        const int i = static_cast<int>(row);
+        size_t idx = row * (2 * static_cast<size_t>(k) - row - 1) / 2;
+        const Moments& a = groups[i];
+        for (int j = i + 1; j < k; ++j, ++idx) {
+            const Moments& b = groups[j];
+            PairComparison& pc = res.pairs[idx];
+            pc.i = i;
+            pc.j = j;
+            pc.diff = a.mean - b.mean;
+
+            double se = std::sqrt(0.5 * msw * (1.0 / a.n + 1.0 / b.n));
+            pc.qTukey = std::abs(pc.diff) / se;
+            pc.pTukey = dist->sf(pc.qTukey, res.df);
+            pc.lowTukey = pc.diff - res.qCrit * se;
+            pc.highTukey = pc.diff + res.qCrit * se;
+
+            double wa = a.variance() / a.n, wb = b.variance() / b.n;
+            double seg = std::sqrt(0.5 * (wa + wb));
+            pc.dfGames = (wa + wb) * (wa + wb) / (wa * wa / (a.n - 1) + wb * wb / (b.n - 1));
+            pc.qGames = std::abs(pc.diff) / seg;
+            pc.pGames = dist->sf(pc.qGames, pc.dfGames);
+            double qg = (*crit)(pc.dfGames);
+            pc.lowGames = pc.diff - qg * seg;
+            pc.highGames = pc.diff + qg * seg;
+        }
+    });
+    return res;
+}
@@ -0,0 +1,82 @@
+#ifndef GROUPSTATS_H
+#define GROUPSTATS_H
+
+#include "sampleview.h"
+#include <vector>
+
+// Сводки групп для дисперсионного анализа и двухвыборочных критериев.
+// Группа описывается тремя числами (n, среднее, сумма квадратов отклонений),
+// поэтому память O(k) при любом объеме групп, а сводки частей выборки
+// складываются (Chan, Golub, LeVeque): группу можно считать кусками
+// параллельно или по мере чтения и объединять без второго прохода.
+struct Moments {
+    double n = 0;
+    double mean = 0;
+    double m2 = 0;            // сумма (x - mean)^2
+
+    // Добавление одного значения (Уэлфорд)
+    void add(double x) {
+        n += 1;
+        double d = x - mean;
+        mean += d / n;
+        m2 += d * (x - mean);
+    }
+    void merge(const Moments& o);
+    double variance() const { return n > 1 ? m2 / (n - 1) : 0.0; }   // s^2
+};
+
+// Сводка массива: блоками по 4096 значений в два прохода по кешу (точно и
+// векторизуемо), блоки объединяются merge по порядку, так что результат не
+// зависит от числа потоков. Параллельно - от 2^20 значений;
+// threads == 0 - предел внутренних потоков radix_sort_threads() (пакетный
+// режим с несколькими файлами ставит 1).
+Moments moments_of(DataView x, unsigned threads = 0);
+
+struct FTest {
+    double f = 0;
+    double df1 = 0, df2 = 0;  // дробные у Уэлча и Брауна-Форсайта
+    double p = 1;             // P(F > f)
+};
+
+// Однофакторный анализ по сводкам групп
+struct OneWayAnova {
+    double grandMean = 0;
+    double ssBetween = 0, ssWithin = 0;
+    FTest classic;            // равные дисперсии
+    FTest welch;              // Уэлч (1951): веса n_i / s_i^2
+    FTest brownForsythe;      // Браун-Форсайт (1974): F* со степенями Саттертуэйта
+};
+OneWayAnova one_way_anova(const std::vector<Moments>& groups);
+
+// Попарные сравнения средних после дисперсионного анализа - по сводкам
+// групп того же прохода. Пары (i < j) идут по строкам: (0,1), (0,2), ...
+struct PairComparison {
+    int i = 0, j = 0;
+    double diff = 0;                    // mean_i - mean_j
+    // Тьюки (HSD; Тьюки-Крамер при разных n): общая внутригрупповая дисперсия
+    double qTukey = 0, pTukey = 1, lowTukey = 0, highTukey = 0;
+    // Геймс-Хауэлл: дисперсии групп и степени свободы Уэлча для пары
+    double qGames = 0, dfGames = 0, pGames = 1, lowGames = 0, highGames = 0;
+};
+
+struct PostHoc {
+    double alpha = 0.05;
+    double df = 0;                      // N - k
+    double qCrit = 0;                   // q_(1 - alpha)(k, N - k)
+    std::vector<PairComparison> pairs;  // k(k-1)/2
+};
+
+// Вероятности - по таблице размаха для k (tukey.h); пары считаются
+// параллельно (threads == 0 - как у moments_of)
+PostHoc post_hoc(const std::vector<Moments>& groups, double alpha, unsigned threads = 0);
+
+// Две выборки: F = большая дисперсия / меньшая, t с объединенной дисперсией и Уэлча
+struct TwoSampleTests {
+    FTest variance;           // p - одностороннее, для большей дисперсии
+    bool firstLarger = true;  // в числителе F дисперсия первой выборки
+    double tPooled = 0, dfPooled = 0, pPooled = 1;   // p двусторонние
+    double tWelch = 0, dfWelch = 0, pWelch = 1;
+};
+TwoSampleTests two_sample_tests(const Moments& a, const Moments& b);
+
+#endif // GROUPSTATS_H
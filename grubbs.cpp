@@ -0,0 +1,108 @@
+#include "grubbs.h"
+#include "runcontrol.h"
+#include <boost/math/distributions/students_t.hpp>
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <tuple>
+
+static double computeCritical(int n, double alpha, bool oneSided) {
+    using namespace boost::math;
+    try {
+        students_t dist(n - 2);
+        double p = oneSided ? (alpha / n) : (alpha / (2.0 * n));
+        double t = quantile(complement(dist, p));
+        return ((n - 1.0) / std::sqrt(static_cast<double>(n))) * std::sqrt((t * t) / (n - 2.0 + t * t));
+    } catch (...) { return 0.0; }
+}
+
+double grubbs_critical(int n, double alpha, bool oneSided) {
+    if (n < 3) return 0.0;
+    static std::mutex mu;
+    static std::map<std::tuple<int, double, bool>, double> cache;
+    const auto key = std::make_tuple(n, alpha, oneSided);
+    {
+        std::lock_guard<std::mutex> lock(mu);
+        auto it = cache.find(key);
+        if (it != cache.end()) return it->second;
+    }
+    double value = computeCritical(n, alpha, oneSided);
+    std::lock_guard<std::mutex> lock(mu);
+    // Объем растет по шагам ESD и от выборки к выборке: без предела кеш
+    // копил бы ключи весь сеанс, как и в tukey.cpp
+    if (cache.size() >= 4096) cache.clear();
+    cache.emplace(key, value);
+    return value;
+}
+
+GrubbsEsd grubbs_esd(DataView sample, int maxOutliers, double alpha, int state, RunControl* control) {
+    GrubbsEsd res;
+    const size_t n = sample.size();
+    if (n < 3 || maxOutliers < 1) return res;
+    const size_t k = std::min(static_cast<size_t>(maxOutliers), n - 2);
+    res.capped = k < static_cast<size_t>(maxOutliers);
+
+    // Концы выборки: k наименьших слева и k наибольших справа по порядку
+    std::vector<double> a(sample.begin(), sample.end());
+    if (2 * k < n) {
+        std::nth_element(a.begin(), a.begin() + k, a.end());
+        std::sort(a.begin(), a.begin() + k);
+        std::nth_element(a.begin() + k, a.end() - k, a.end());
+        std::sort(a.end() - k, a.end());
+    } else {
+        std::sort(a.begin(), a.end());
+    }
+
+    double mean = 0, m2 = 0;
+    for (size_t i = 0; i < n; ++i) {
+        double d = a[i] - mean;
+        mean += d / (i + 1);
+        m2 += d * (a[i] - mean);
+    }
+
+    // Оставшиеся значения всегда лежат в a[lo..hi]
+    size_t lo = 0, hi = n - 1;
+    const size_t progressStride = k / 256 + 1;
+    for (size_t step = 0; step < k; ++step) {
+        if (control) {
+            if (control->cancelled()) break;
+            if (step % progressStride == 0) control->setProgress(static_cast<double>(step) / k);
+        }
+        const size_t cnt = hi - lo + 1;
+        double s = std::sqrt(std::max(m2, 0.0) / (cnt - 1.0));
+        if (!(s > 0)) { res.degenerate = true; break; }
+        double uMax = (a[hi] - mean) / s;
+        double uMin = (mean - a[lo]) / s;
+        bool takeMax = (state == 1) || (state == 0 && uMax >= uMin);
+
+        GrubbsStep st;
+        st.n = static_cast<int>(cnt);
+        st.mean = mean;
+        st.stdDev = s;
+        st.value = takeMax ? a[hi] : a[lo];
+        st.statistic = takeMax ? uMax : uMin;
+        st.critical = grubbs_critical(st.n, alpha, state != 0);
+        res.steps.push_back(st);
+        if (st.statistic > st.critical) res.outliers = static_cast<int>(res.steps.size());
+
+        // Удаление по Уэлфорду
+        const double x = st.value;
+        if (takeMax) --hi; else ++lo;
+        double newMean = mean - (x - mean) / (cnt - 1.0);
+        double newM2 = m2 - (x - mean) * (x - newMean);
+        // Удален выброс, на котором держалась почти вся сумма: разность
+        // потеряла точность, остаток пересчитывается заново (редкий случай)
+        if (newM2 < 1e-8 * m2) {
+            newMean = 0; newM2 = 0;
+            for (size_t i = lo, j = 0; i <= hi; ++i, ++j) {
+                double d = a[i] - newMean;
+                newMean += d / (j + 1);
+                newM2 += d * (a[i] - newMean);
+            }
+        }
+        mean = newMean;
+        m2 = newM2;
+    }
+    return res;
+}
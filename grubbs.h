@@ -0,0 +1,46 @@
+#ifndef GRUBBS_H
+#define GRUBBS_H
+
+#include "sampleview.h"
+#include <vector>
+
+class RunControl;   // runcontrol.h
+
+// Критерий Граббса и его обобщение на несколько выбросов (generalized ESD,
+// Rosner 1983). На шаге i из текущей выборки объема n_i удаляется самое
+// удаленное от среднего значение, статистика R_i = |x - mean| / s сравнивается
+// с критическим lambda_i; число выбросов - наибольшее i с R_i > lambda_i
+// (проверяется вся последовательность, а не до первого непревышения).
+//
+// Кандидаты берутся двумя указателями с концов упорядоченной выборки (нужны
+// только k наименьших и k наибольших - частичная сортировка, O(n + k log k)),
+// а среднее и сумма квадратов отклонений обновляются при удалении по формуле
+// Уэлфорда, так что каждый шаг стоит O(1) и выборка не просматривается заново.
+
+// state из .inp: 0 - двусторонний, 1 - проверяется максимум, 2 - минимум
+struct GrubbsStep {
+    int n;             // объем выборки на шаге
+    double mean;
+    double stdDev;
+    double value;      // кандидат в выбросы
+    double statistic;  // R_i
+    double critical;   // lambda_i
+};
+
+struct GrubbsEsd {
+    std::vector<GrubbsStep> steps;
+    int outliers = 0;         // число значений, признанных выбросами (первые в steps)
+    bool capped = false;      // maxOutliers больше n - 2: шагов не больше n - 2
+    bool degenerate = false;  // шаги оборваны: остаток выборки из равных значений (s = 0)
+};
+
+// Критическое значение для выборки объема n (n >= 3); кешируется по
+// (n, alpha, сторона) - не больше 4096 значений, поэтому серии выборок
+// одного объема считают квантиль распределения Стьюдента один раз
+double grubbs_critical(int n, double alpha, bool oneSided);
+
+// До maxOutliers шагов, но не дальше объема 3. control - отмена (шаги
+// обрываются, результат неполный) и прогресс по шагам.
+GrubbsEsd grubbs_esd(DataView sample, int maxOutliers, double alpha, int state, RunControl* control = nullptr);
+
+#endif // GRUBBS_H
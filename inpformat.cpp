@@ -0,0 +1,132 @@
+#include "inpformat.h"
+#include <cctype>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+// Плавающий from_chars есть в libstdc++ 11+ и MSVC, в libc++ - только с LLVM 20;
+// иначе strtod по копии лексемы в стековом буфере
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+#define INP_FLOAT_FROM_CHARS 1
+#endif
+
+void InpSample::clear() {
+    samplesSize = -1;
+    beta = 0;
+    data.clear();
+    cens.clear();
+    p.clear();
+}
+
+bool inpToDouble(const char* b, const char* e, double& v) {
+    if (b != e && *b == '+') ++b;
+    if (b == e) return false;
+#ifdef INP_FLOAT_FROM_CHARS
+    std::from_chars_result res = std::from_chars(b, e, v);
+    return res.ec == std::errc() && res.ptr == e;
+#else
+    char tmp[64];
+    size_t len = static_cast<size_t>(e - b);
+    if (len >= sizeof(tmp)) return false;
+    std::memcpy(tmp, b, len);
+    tmp[len] = '\0';
+    char* stop = nullptr;
+    v = std::strtod(tmp, &stop);
+    return stop == tmp + len;
+#endif
+}
+
+bool inpToInt(const char* b, const char* e, long long& v) {
+    if (b != e && *b == '+') ++b;
+    std::from_chars_result res = std::from_chars(b, e, v);
+    if (res.ec == std::errc() && res.ptr == e) return true;
+    // "1.0" и "1e3" в целочисленных полях тоже встречаются
+    double d;
+    if (!inpToDouble(b, e, d)) return false;
+    v = static_cast<long long>(d);
+    return true;
+}
+
+static bool tokenIs(const char* b, const char* e, const char* kw) {
+    size_t len = std::strlen(kw);
+    return static_cast<size_t>(e - b) == len && std::memcmp(b, kw, len) == 0;
+}
+
+bool parseInpBuffer(const char* begin, const char* end, InpSample& s) {
+    s.clear();
+
+    enum Block { Positional, SampleSize, Beta, Data, Cens, Probs, Skip };
+    Block block = Positional;
+
+    const char* p = begin;
+    const char* tb;
+    const char* te;
+    while (inpNextToken(p, end, tb, te)) {
+        if (std::isalpha(static_cast<unsigned char>(*tb))) {
+            // Ключевое слово: числа до него были не позиционным форматом
+            if (block == Positional) s.data.clear();
+            if (tokenIs(tb, te, "Data") || tokenIs(tb, te, "X")) block = Data;
+            else if (tokenIs(tb, te, "Censorizes") || tokenIs(tb, te, "R")) block = Cens;
+            else if (tokenIs(tb, te, "Samples_size")) block = SampleSize;
+            else if (tokenIs(tb, te, "beta")) block = Beta;
+            else if (tokenIs(tb, te, "P")) block = Probs;
+            else block = Skip;
+            continue;
+        }
+
+        switch (block) {
+        case Positional:
+        case Data: {
+            double v;
+            if (inpToDouble(tb, te, v)) s.data.push_back(v);
+            break;
+        }
+        case Cens: {
+            long long v;
+            if (inpToInt(tb, te, v)) s.cens.push_back(static_cast<int>(v));
+            break;
+        }
+        case Probs: {
+            double v;
+            if (inpToDouble(tb, te, v)) s.p.push_back(v);
+            break;
+        }
+        case SampleSize: {
+            long long v;
+            if (inpToInt(tb, te, v)) s.samplesSize = v;
+            block = Skip;
+            break;
+        }
+        case Beta: {
+            double v;
+            if (inpToDouble(tb, te, v)) s.beta = v;
+            block = Skip;
+            break;
+        }
+        case Skip:
+            break;
+        }
+    }
+
+    if (s.samplesSize >= 0 && s.data.size() > static_cast<size_t>(s.samplesSize))
+        s.data.resize(static_cast<size_t>(s.samplesSize));
+    if (s.data.empty()) return false;
+    if (s.cens.size() != s.data.size()) s.cens.assign(s.data.size(), 0);
+    return true;
+}
+
+bool parseInpFile(const std::string& path, InpSample& s, std::string& error) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) { error = path + ": не удалось открыть"; s.clear(); return false; }
+    in.seekg(0, std::ios::end);
+    std::string buf(static_cast<size_t>(in.tellg()), '\0');
+    in.seekg(0);
+    in.read(&buf[0], static_cast<std::streamsize>(buf.size()));
+
+    if (!parseInpBuffer(buf.data(), buf.data() + buf.size(), s)) {
+        error = path + ": не удалось распознать числа";
+        return false;
+    }
+    return true;
+}
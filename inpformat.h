@@ -0,0 +1,47 @@
+#ifndef INPFORMAT_H
+#define INPFORMAT_H
+
+#include <string>
+#include <vector>
+
+// Общий разбор формата .inp для GUI, пакетного режима и потокового чтения.
+// Именованные блоки: Samples_size (n), beta, Data (X), Censorizes (R), P;
+// прочие ключевые слова (eps_output, kp, ...) пропускаются вместе с числами.
+// Файл без ключевых слов - позиционный формат (Граббс, Уилкоксон, ANOVA):
+// все числа подряд попадают в data.
+struct InpSample {
+    long long samplesSize = -1;   // -1 - не указан
+    double beta = 0;              // 0 - не указан
+    std::vector<double> data;
+    std::vector<int> cens;
+    std::vector<double> p;
+
+    void clear();
+};
+
+// Лексемы разделяются пробелами, ',' и ';'
+inline bool inpIsSeparator(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == ',' || c == ';';
+}
+
+// Следующая лексема [tb, te) начиная с p; p сдвигается за нее
+inline bool inpNextToken(const char*& p, const char* end, const char*& tb, const char*& te) {
+    while (p != end && inpIsSeparator(*p)) ++p;
+    if (p == end) return false;
+    tb = p;
+    while (p != end && !inpIsSeparator(*p)) ++p;
+    te = p;
+    return true;
+}
+
+// Число целиком занимает лексему; без исключений и выделений памяти
+bool inpToDouble(const char* b, const char* e, double& v);
+bool inpToInt(const char* b, const char* e, long long& v);
+
+// Разбор текста из памяти. Векторы s только очищаются, их емкость
+// переиспользуется между вызовами. Data обрезается до Samples_size;
+// цензура другой длины заменяется нулями. false - не найдено ни одного числа.
+bool parseInpBuffer(const char* begin, const char* end, InpSample& s);
+bool parseInpFile(const std::string& path, InpSample& s, std::string& error);
+
+#endif // INPFORMAT_H
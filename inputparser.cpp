@@ -0,0 +1,12 @@
+#include "inputparser.h"
+#include "inpformat.h"
+#include <QByteArray>
+
+bool parseInpText(const QString& text, std::vector<double>& data, std::vector<int>& cens) {
+    const QByteArray utf8 = text.toUtf8();
+    InpSample s;
+    bool ok = parseInpBuffer(utf8.constData(), utf8.constData() + utf8.size(), s);
+    data.swap(s.data);
+    cens.swap(s.cens);
+    return ok;
+}
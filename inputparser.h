@@ -0,0 +1,14 @@
+#ifndef INPUTPARSER_H
+#define INPUTPARSER_H
+
+#include <QString>
+#include <vector>
+
+// Разбор текста .inp из окна ввода общим парсером parseInpBuffer (inpformat.h):
+// блоки "Data"/"Censorizes" или, если ключевых слов нет, все числа подряд
+// (позиционные форматы Граббса, Уилкоксона, ANOVA).
+// Если цензуры нет или ее длина не совпадает с данными - заполняется нулями.
+// Возвращает false, если не найдено ни одного числа.
+bool parseInpText(const QString& text, std::vector<double>& data, std::vector<int>& cens);
+
+#endif // INPUTPARSER_H
@@ -1,24 +1,19 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
-#include "Method_MLE_Normal.h"
-#include "Method_MLE_Weibull.h"
-#include "Method_MLS_Normal.h"
-#include "Method_MLS_Weibull.h"
-#include "Method_Grubbs.h"
-#include "Method_FisherStudent.h"
-#include "Method_Anova.h"
-#include "Method_ShapiroWilk.h"
-#include "Method_Wilcoxon.h"
+#include "MethodRegistry.h"
+#include "inputparser.h"
 #include <QtCharts/QLineSeries>
 #include <QtCharts/QScatterSeries>
 #include <QtCharts/QValueAxis>
 #include <QtCharts/QLogValueAxis>
-#include <QRegularExpression>
 #include <QFileDialog>
 #include <QFile>
 #include <QTextStream>
 #include <QMessageBox>
 #include <QDateTime>
+#include <QStatusBar>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentRun>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent), ui(new Ui::MainWindow), chart(new QChart())
@@ -31,6 +26,21 @@ MainWindow::MainWindow(QWidget *parent)
         ui->chartContainer->setRenderHint(QPainter::Antialiasing);
         ui->chartContainer->setRubberBand(QChartView::RectangleRubberBand);
     }
+    connect(chart, &QChart::plotAreaChanged, this, [this](const QRectF&) { scheduleLodRefresh(); });
+
+    // Прогресс и отмена фонового расчета - в строке состояния
+    progressBar = new QProgressBar(this);
+    progressBar->setMaximumWidth(200);
+    progressBar->setTextVisible(false);
+    progressBar->hide();
+    cancelButton = new QPushButton("Отмена", this);
+    cancelButton->hide();
+    ui->statusbar->addPermanentWidget(progressBar);
+    ui->statusbar->addPermanentWidget(cancelButton);
+    progressTimer = new QTimer(this);
+    progressTimer->setInterval(100);
+    connect(progressTimer, &QTimer::timeout, this, &MainWindow::updateProgress);
+    connect(cancelButton, &QPushButton::clicked, this, &MainWindow::cancelCalculation);
 
     // Соединяем сигналы и слоты
     connect(ui->treeWidget, &QTreeWidget::itemClicked, this, &MainWindow::handleMenuClick);
@@ -40,18 +50,15 @@ MainWindow::MainWindow(QWidget *parent)
 }
 
 void MainWindow::registerMethods() {
-    methodsMap["Нормальное распределение"] = new Method_MLE_Normal();
-    methodsMap["Распределение Вейбулла-Гнеденко"] = new Method_MLE_Weibull();
-    methodsMap["Нормальное распределение MLS"] = new Method_MLS_Normal();
-    methodsMap["Распределение Вейбулла-Гнеденко MLS"] = new Method_MLS_Weibull();
-    methodsMap["Критерий Граббса"] = new Method_Grubbs();
-    methodsMap["Критерий Фишера-Стьюдента"] = new Method_FisherStudent();
-    methodsMap["Однофакторный дисперсионный анализ (ANOVA)"] = new Method_Anova();
-    methodsMap["Критерий Шапило-Уилка (W-критерий)"] = new Method_ShapiroWilk();
-    methodsMap["Двухвыборочный критерий Уилкоксона"] = new Method_Wilcoxon();
+    for (const MethodInfo& info : methodRegistry()) {
+        methodsMap[QString::fromUtf8(info.title)] = info.create();
+    }
 }
 
 MainWindow::~MainWindow() {
+    // Фоновые расчеты держат указатели на методы: дождаться их до удаления
+    if (running) running->cancel();
+    QThreadPool::globalInstance()->waitForDone();
     qDeleteAll(methodsMap);
     delete ui;
 }
@@ -70,36 +77,6 @@ void MainWindow::on_btn_1_clicked() {
         return;
     }
 
-    std::vector<double> data;
-    std::vector<int> cens;
-
-    QStringList lines = inputStr.split('\n', Qt::SkipEmptyParts);
-    for (int i = 0; i < lines.size(); ++i) {
-        QString line = lines[i].trimmed();
-        if (line == "Data" && i + 1 < lines.size()) {
-            QStringList vals = lines[i+1].trimmed().split(QRegularExpression("\\s+"), Qt::SkipEmptyParts);
-            for(const QString &v : vals) data.push_back(v.toDouble());
-        }
-        else if (line == "Censorizes" && i + 1 < lines.size()) {
-            QStringList vals = lines[i+1].trimmed().split(QRegularExpression("\\s+"), Qt::SkipEmptyParts);
-            for(const QString &v : vals) cens.push_back(v.toInt());
-        }
-    }
-
-    if (data.empty()) {
-        QStringList parts = inputStr.split(QRegularExpression("\\s+"), Qt::SkipEmptyParts);
-        for(const QString& p : parts) {
-            bool ok;
-            double val = p.toDouble(&ok);
-            if(ok) data.push_back(val);
-        }
-    }
-
-    if (data.empty()) {
-        ui->textEdit_output->setText("Ошибка: Не удалось распознать числа в блоке Data!");
-        return;
-    }
-
     QTreeWidgetItem* item = ui->treeWidget->currentItem();
     if (!item) {
         ui->textEdit_output->setText("Ошибка: Сначала выберите распределение в списке слева!");
@@ -107,17 +84,82 @@ void MainWindow::on_btn_1_clicked() {
     }
 
     QString methodName = item->text(0);
-    if (methodsMap.contains(methodName)) {
-        AbstractMethod* method = methodsMap[methodName];
+    if (methodsMap.contains(methodName)) startCalculation(inputStr, methodName);
+}
 
-        if (cens.size() != data.size()) cens.assign(data.size(), 0);
+// Разбор и расчет идут в пуле QtConcurrent, окно остается отзывчивым.
+// Оценки проверяют отмену в своих итерациях через RunControl потока;
+// результат возвращается в поток окна сигналом QFutureWatcher.
+void MainWindow::startCalculation(const QString& input, const QString& methodName) {
+    if (running) running->cancel();
+    auto control = std::make_shared<RunControl>();
+    running = control;
+    const quint64 id = ++runId;
+    const AbstractMethod* method = methodsMap[methodName];
+
+    auto* watcher = new QFutureWatcher<CalcOutcome>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, id, methodName, watcher] {
+        onCalculationFinished(id, methodName, watcher);
+    });
+    watcher->setFuture(QtConcurrent::run([input, method, control] {
+        RunControlScope scope(control.get());
+        CalcOutcome out;
+        std::vector<double> data;
+        std::vector<int> cens;
+        parseInpText(input, data, cens);
+        if (data.empty()) {
+            out.error = "Ошибка: Не удалось распознать числа в блоке Data!";
+            return out;
+        }
+        out.hasGraph = method->hasGraph();
+        out.result = method->calculate(data, cens, out.hasGraph);
+        return out;
+    }));
+
+    progressBar->setRange(0, 0);
+    progressBar->show();
+    cancelButton->show();
+    progressTimer->start();
+    ui->statusbar->showMessage("Расчет: " + methodName);
+}
+
+void MainWindow::onCalculationFinished(quint64 id, const QString& methodName, QFutureWatcher<CalcOutcome>* watcher) {
+    watcher->deleteLater();
+    // Вытесненный или отмененный расчет досчитан не до конца - отбрасывается
+    if (id != runId || !running || running->cancelled()) return;
+    running.reset();
+    progressTimer->stop();
+    progressBar->hide();
+    cancelButton->hide();
+    ui->statusbar->clearMessage();
+
+    const CalcOutcome out = watcher->result();
+    if (!out.error.isEmpty()) {
+        ui->textEdit_output->setText(out.error);
+        return;
+    }
+    ui->textEdit_output->setText(out.result.report);
+    if (out.hasGraph) plotGraph(out.result.graph, methodName);
+}
 
-        QString report = method->calculate(data, cens);
-        ui->textEdit_output->setText(report);
+void MainWindow::cancelCalculation() {
+    if (!running) return;
+    running->cancel();
+    running.reset();
+    progressTimer->stop();
+    progressBar->hide();
+    cancelButton->hide();
+    ui->statusbar->showMessage("Расчет отменен", 3000);
+}
 
-        if (method->hasGraph()) {
-            plotGraph(method->getGraphData());
-        }
+void MainWindow::updateProgress() {
+    if (!running) return;
+    double p = running->progress();
+    if (p < 0) {
+        progressBar->setRange(0, 0);   // неизвестно сколько - бегущий индикатор
+    } else {
+        progressBar->setRange(0, 1000);
+        progressBar->setValue(static_cast<int>(p * 1000));
     }
 }
 
@@ -136,7 +178,9 @@ void MainWindow::onLoadInpFile() {
     on_btn_1_clicked();
 }
 
-void MainWindow::plotGraph(const std::vector<GraphSeriesData>& seriesList) {
+void MainWindow::plotGraph(const std::vector<GraphSeriesData>& seriesList, const QString& methodName) {
+    lodSeries.clear();
+    lodTargets.clear();
     chart->removeAllSeries();
 
     // Очищаем старые оси
@@ -147,14 +191,9 @@ void MainWindow::plotGraph(const std::vector<GraphSeriesData>& seriesList) {
 
     if (seriesList.empty()) return;
 
-    // 1. ОПРЕДЕЛЯЕМ ТИП ОСИ
-    bool useLogX = false;
-    if (ui->treeWidget->currentItem()) {
-        QString currentMethod = ui->treeWidget->currentItem()->text(0);
-        if (currentMethod.contains("Вейбулл")) {
-            useLogX = true;
-        }
-    }
+    // 1. ОПРЕДЕЛЯЕМ ТИП ОСИ (по методу расчета: выбор в дереве мог смениться)
+    bool useLogX = methodName.contains("Вейбулл");
+    lodLogX = useLogX;
 
     // 2. СОЗДАЕМ ОСИ
     QAbstractAxis *axisX;
@@ -226,16 +265,67 @@ void MainWindow::plotGraph(const std::vector<GraphSeriesData>& seriesList) {
             series = line;
         }
 
+        // Точки загружаются в refreshLod одним replace, уже прореженными
         series->setName(sName);
-        for (size_t i = 0; i < sData.x.size(); ++i) {
-            series->append(sData.x[i], sData.y[i]);
-        }
+        lodSeries.emplace_back(sData, useLogX);
+        lodTargets.push_back(series);
 
         chart->addSeries(series);
         series->attachAxis(axisX);
         series->attachAxis(axisY);
     }
     chart->legend()->setVisible(true);
+
+    // Масштаб рамкой (и возврат правой кнопкой) меняет диапазоны осей
+    connect(axisY, &QValueAxis::rangeChanged, this, &MainWindow::scheduleLodRefresh);
+    if (useLogX)
+        connect(static_cast<QLogValueAxis*>(axisX), &QLogValueAxis::rangeChanged, this, &MainWindow::scheduleLodRefresh);
+    else
+        connect(static_cast<QValueAxis*>(axisX), &QValueAxis::rangeChanged, this, &MainWindow::scheduleLodRefresh);
+    refreshLod();
+}
+
+// Обе оси меняются при одном масштабировании - пересчет один, после них
+void MainWindow::scheduleLodRefresh() {
+    if (lodPending || lodTargets.empty()) return;
+    lodPending = true;
+    QTimer::singleShot(0, this, &MainWindow::refreshLod);
+}
+
+void MainWindow::refreshLod() {
+    lodPending = false;
+    const QList<QAbstractAxis*> axesX = chart->axes(Qt::Horizontal);
+    const QList<QAbstractAxis*> axesY = chart->axes(Qt::Vertical);
+    if (lodTargets.empty() || axesX.isEmpty() || axesY.isEmpty()) return;
+
+    PlotViewport view;
+    view.logX = lodLogX;
+    if (lodLogX) {
+        auto *a = static_cast<QLogValueAxis*>(axesX.first());
+        view.xMin = a->min(); view.xMax = a->max();
+    } else {
+        auto *a = static_cast<QValueAxis*>(axesX.first());
+        view.xMin = a->min(); view.xMax = a->max();
+    }
+    auto *ay = static_cast<QValueAxis*>(axesY.first());
+    view.yMin = ay->min(); view.yMax = ay->max();
+
+    // До первой раскладки область построения пуста - берем размер виджета
+    QSizeF area = chart->plotArea().size();
+    if (area.isEmpty() && ui->chartContainer) area = ui->chartContainer->size();
+    const qreal dpr = ui->chartContainer ? ui->chartContainer->devicePixelRatioF() : 1.0;
+    if (!area.isEmpty()) {
+        view.width = std::max(1, static_cast<int>(area.width() * dpr));
+        view.height = std::max(1, static_cast<int>(area.height() * dpr));
+    }
+
+    std::vector<double> xs, ys;
+    for (size_t k = 0; k < lodTargets.size(); ++k) {
+        lodSeries[k].decimate(view, xs, ys);
+        QVector<QPointF> points(static_cast<int>(xs.size()));
+        for (size_t i = 0; i < xs.size(); ++i) points[static_cast<int>(i)] = QPointF(xs[i], ys[i]);
+        lodTargets[k]->replace(points);
+    }
 }
 
 void MainWindow::on_btn_2_clicked() {
@@ -4,9 +4,18 @@
 #include <QMainWindow>
 #include <QTreeWidget>
 #include <QMap>
+#include <QFutureWatcher>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QTimer>
 #include <QtCharts/QChart>
 #include <QtCharts/QChartView>
+#include <QtCharts/QXYSeries>
+#include <memory>
+#include <vector>
 #include "AbstractMethod.h"
+#include "plotlod.h"
+#include "runcontrol.h"
 
 QT_USE_NAMESPACE
 
@@ -14,6 +23,13 @@ QT_USE_NAMESPACE
 namespace Ui { class MainWindow; }
 QT_END_NAMESPACE
 
+// Результат фонового расчета, передается в поток окна
+struct CalcOutcome {
+    QString error;
+    MethodResult result;
+    bool hasGraph = false;
+};
+
 class MainWindow : public QMainWindow {
     Q_OBJECT
 
@@ -29,9 +45,29 @@ private slots:
 
 private:
     Ui::MainWindow *ui;
-    QMap<QString, AbstractMethod*> methodsMap;
+    QMap<QString, const AbstractMethod*> methodsMap;
     void registerMethods();
-    void plotGraph(const std::vector<GraphSeriesData>& seriesList);
+    void plotGraph(const std::vector<GraphSeriesData>& seriesList, const QString& methodName);
+
+    // Уровни детализации: серии графика прореживаются под видимую область
+    // и пересчитываются при масштабировании рамкой и изменении размера
+    void scheduleLodRefresh();
+    void refreshLod();
+    std::vector<LodSeries> lodSeries;
+    std::vector<QXYSeries*> lodTargets;    // серии графика, по одной на lodSeries
+    bool lodLogX = false;
+    bool lodPending = false;
+
+    // Фоновый расчет: новый запрос отменяет выполняющийся, а не ждет его
+    void startCalculation(const QString& input, const QString& methodName);
+    void onCalculationFinished(quint64 id, const QString& methodName, QFutureWatcher<CalcOutcome>* watcher);
+    void cancelCalculation();
+    void updateProgress();
+    std::shared_ptr<RunControl> running;   // nullptr - расчета нет
+    quint64 runId = 0;                     // номер последнего запроса
+    QProgressBar *progressBar;
+    QPushButton *cancelButton;
+    QTimer *progressTimer;
     void saveOutputToFile(const QString& filePath, const QString& content);  // Обновленный метод
 
     QChart *chart;
@@ -1,13 +1,184 @@
 #ifndef NELDERMEAD_H
 #define NELDERMEAD_H
 
+#include "sampleview.h"
+#include "parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <vector>
-#include <functional>
 
-int neldermead(
-    std::vector<double>& x0,
-    double eps,
-    std::function<double(std::vector<double>)> func
-    );
+struct NelderMeadOptions {
+    double eps = 1e-8;            // порог СКО значений функции в вершинах
+    int maxIterations = 1000;
+    double step = 0.05;           // относительный шаг начального симплекса
+    double zeroStep = 0.00025;    // шаг по нулевой координате
+    // Рестарты: первый из x0, остальные из x0 со случайным относительным
+    // сдвигом до ±spread по каждой координате. Прогоны идут параллельно,
+    // точки стартов зависят только от seed, а не от числа потоков.
+    size_t restarts = 1;
+    double spread = 0.5;
+    unsigned threads = 0;         // 0 - по числу ядер
+    uint64_t seed = 20240917;
+};
+
+struct NelderMeadRun {
+    std::vector<double> x;
+    double fx = 0;
+    int iterations = 0;
+    long evaluations = 0;
+    bool converged = false;       // остановка по eps, а не по maxIterations
+};
+
+struct NelderMeadResult {
+    NelderMeadRun best;
+    size_t bestIndex = 0;
+    std::vector<NelderMeadRun> runs;   // по одному на рестарт
+};
+
+// Точки стартов подряд: count блоков по x0.size() координат
+std::vector<double> nelder_mead_starts(DataView x0, size_t count, double spread, uint64_t seed);
+
+// Один прогон симплекс-метода. f вызывается как f(DataView) -> double и
+// получает указатель внутрь рабочего буфера, так что вычисление целевой
+// функции ничего не выделяет. Вся память (вершины одним блоком (n+1)*n,
+// центроид и пробные точки) заводится один раз на прогон. Вершины не
+// сортируются: на итерации ищутся только лучшая, худшая и вторая худшая.
+template <class F>
+NelderMeadRun nelder_mead_run(F& f, DataView x0, const NelderMeadOptions& opt) {
+    const double alpha = 1.0, gamma = 2.0, beta = 0.5, delta = 0.5;
+    const size_t n = x0.size(), m = n + 1;
+    NelderMeadRun run;
+    if (n == 0) return run;
+
+    std::vector<double> buf((m + 4) * n), fv(m);
+    double* v = buf.data();
+    double* cen = v + m * n;
+    double* xr = cen + n;
+    double* xe = xr + n;
+    double* xc = xe + n;
+    auto vert = [&](size_t i) { return v + i * n; };
+    auto eval = [&](const double* p) {
+        ++run.evaluations;
+        return static_cast<double>(f(DataView(p, n)));
+    };
+    auto point = [&](double coeff, const double* worst, double* out) {
+        for (size_t j = 0; j < n; ++j) out[j] = (1.0 + coeff) * cen[j] - coeff * worst[j];
+    };
+    auto assign = [&](size_t i, const double* p, double fp) {
+        std::copy(p, p + n, vert(i));
+        fv[i] = fp;
+    };
+
+    // Начальный симплекс
+    std::copy(x0.begin(), x0.end(), v);
+    fv[0] = eval(v);
+    for (size_t i = 1; i < m; ++i) {
+        double* p = vert(i);
+        std::copy(x0.begin(), x0.end(), p);
+        p[i - 1] += (x0[i - 1] != 0) ? opt.step * x0[i - 1] : opt.zeroStep;
+        fv[i] = eval(p);
+    }
+
+    size_t lo = 0;
+    while (run.iterations < opt.maxIterations) {
+        ++run.iterations;
+
+        // Частичное упорядочивание за один проход
+        size_t hi = 0;
+        lo = 0;
+        for (size_t i = 1; i < m; ++i) {
+            if (fv[i] < fv[lo]) lo = i;
+            if (fv[i] >= fv[hi]) hi = i;
+        }
+        size_t nh = lo;
+        for (size_t i = 0; i < m; ++i)
+            if (i != hi && fv[i] > fv[nh]) nh = i;
+
+        // Проверка сходимости
+        double var = 0;
+        for (size_t i = 0; i < m; ++i) var += (fv[i] - fv[lo]) * (fv[i] - fv[lo]);
+        if (std::sqrt(var / m) < opt.eps) { run.converged = true; break; }
+
+        // Центроид всех вершин, кроме худшей
+        std::fill(cen, cen + n, 0.0);
+        for (size_t i = 0; i < m; ++i) {
+            if (i == hi) continue;
+            const double* p = vert(i);
+            for (size_t j = 0; j < n; ++j) cen[j] += p[j];
+        }
+        for (size_t j = 0; j < n; ++j) cen[j] /= n;
+
+        // Отражение
+        const double* worst = vert(hi);
+        point(alpha, worst, xr);
+        double fxr = eval(xr);
+        if (fv[lo] <= fxr && fxr < fv[nh]) { assign(hi, xr, fxr); continue; }
+
+        // Растяжение
+        if (fxr < fv[lo]) {
+            point(gamma, worst, xe);
+            double fxe = eval(xe);
+            if (fxe < fxr) assign(hi, xe, fxe);
+            else assign(hi, xr, fxr);
+            continue;
+        }
+
+        // Сжатие: внешнее, если отраженная точка лучше худшей, иначе внутреннее
+        bool outside = fxr < fv[hi];
+        point(outside ? beta * alpha : -beta, worst, xc);
+        double fxc = eval(xc);
+        if (fxc < (outside ? fxr : fv[hi])) { assign(hi, xc, fxc); continue; }
+
+        // Редукция к лучшей вершине
+        const double* best = vert(lo);
+        for (size_t i = 0; i < m; ++i) {
+            if (i == lo) continue;
+            double* p = vert(i);
+            for (size_t j = 0; j < n; ++j) p[j] = best[j] + delta * (p[j] - best[j]);
+            fv[i] = eval(p);
+        }
+    }
+
+    lo = 0;
+    for (size_t i = 1; i < m; ++i)
+        if (fv[i] < fv[lo]) lo = i;
+    run.x.assign(vert(lo), vert(lo) + n);
+    run.fx = fv[lo];
+    return run;
+}
+
+// Минимизация с рестартами; лучший прогон - с наименьшим fx (при равенстве
+// - с меньшим номером). При restarts > 1 f вызывается из нескольких потоков
+// одновременно и должна быть безопасна для этого (обычно - const-лямбда).
+template <class F>
+NelderMeadResult nelder_mead(F f, DataView x0, const NelderMeadOptions& opt = NelderMeadOptions()) {
+    NelderMeadResult res;
+    const size_t count = opt.restarts ? opt.restarts : 1, n = x0.size();
+    res.runs.resize(count);
+    if (count == 1) {
+        res.runs[0] = nelder_mead_run(f, x0, opt);
+    } else {
+        std::vector<double> starts = nelder_mead_starts(x0, count, opt.spread, opt.seed);
+        parallel_for(count, opt.threads, [&](size_t i, unsigned) {
+            F local(f);
+            res.runs[i] = nelder_mead_run(local, DataView(starts.data() + i * n, n), opt);
+        });
+    }
+    for (size_t i = 1; i < count; ++i)
+        if (res.runs[i].fx < res.runs[res.bestIndex].fx) res.bestIndex = i;
+    res.best = res.runs[res.bestIndex];
+    return res;
+}
+
+// Прежний интерфейс: x0 заменяется найденной точкой, возвращается число итераций
+template <class F>
+int neldermead(std::vector<double>& x0, double eps, F func) {
+    NelderMeadOptions opt;
+    opt.eps = eps;
+    NelderMeadRun run = nelder_mead_run(func, x0, opt);
+    if (!run.x.empty()) x0 = run.x;
+    return run.iterations;
+}
 
 #endif // NELDERMEAD_H
@@ -0,0 +1,264 @@
+#include "normaldist.h"
+#include "simdexp.h"
+#include <cmath>
+#include <limits>
+
+static inline double ppfCentral(double q) {
+    const double r = 0.180625 - q * q;
+    return q * (((((((2.5090809287301226727e+3 * r + 3.3430575583588128105e+4) * r + 6.7265770927008700853e+4) * r
+                    + 4.5921953931549871457e+4) * r + 1.3731693765509461125e+4) * r + 1.9715909503065514427e+3) * r
+                 + 1.3314166789178437745e+2) * r + 3.3871328727963666080e0)
+             / (((((((5.2264952788528545610e+3 * r + 2.8729085735721942674e+4) * r + 3.9307895800092710610e+4) * r
+                    + 2.1213794301586595867e+4) * r + 5.3941960214247511077e+3) * r + 6.8718700749205790830e+2) * r
+                 + 4.2313330701600911252e+1) * r + 1.0);
+}
+
+static double ppfTail(double p, double q) {
+    double r = q < 0 ? p : 1.0 - p;
+    if (r <= 0) return q < 0 ? -std::numeric_limits<double>::infinity() : std::numeric_limits<double>::infinity();
+    r = std::sqrt(-std::log(r));
+    double val;
+    if (r <= 5.0) {
+        r -= 1.6;
+        val = (((((((7.74545014278341407640e-4 * r + 2.27238449892691845833e-2) * r + 2.41780725177450611770e-1) * r
+                   + 1.27045825245236838258e0) * r + 3.64784832476320460504e0) * r + 5.76949722146069140550e0) * r
+                + 4.63033784615654529590e0) * r + 1.42343711074968357734e0)
+            / (((((((1.05075007164441684324e-9 * r + 5.47593808499534494600e-4) * r + 1.51986665636164571966e-2) * r
+                   + 1.48103976427480074590e-1) * r + 6.89767334985100004550e-1) * r + 1.67638483018380384940e0) * r
+                + 2.05319162663775882187e0) * r + 1.0);
+    } else {
+        r -= 5.0;
+        val = (((((((2.01033439929228813265e-7 * r + 2.71155556874348757815e-5) * r + 1.24266094738807843860e-3) * r
+                   + 2.65321895265761230930e-2) * r + 2.96560571828504891230e-1) * r + 1.78482653991729133580e0) * r
+                + 5.46378491116411436990e0) * r + 6.65790464350110377720e0)
+            / (((((((2.04426310338993978564e-15 * r + 1.42151175831644588870e-7) * r + 1.84631831751005468180e-5) * r
+                   + 7.86869131145613259100e-4) * r + 1.48753612908506148525e-2) * r + 1.36929880922735805310e-1) * r
+                + 5.99832206555887937690e-1) * r + 1.0);
+    }
+    return q < 0 ? -val : val;
+}
+
+double norm_ppf_as241(double p) {
+    const double q = p - 0.5;
+    return std::abs(q) <= 0.425 ? ppfCentral(q) : ppfTail(p, q);
+}
+
+void norm_ppf_batch(const double* p, double* out, size_t n) {
+    // Плотный проход без ветвлений: хвостовые точки тоже посчитаются, но с
+    // зажатым аргументом, и будут перезаписаны ниже
+    for (size_t i = 0; i < n; ++i) {
+        double q = p[i] - 0.5;
+        q = q > 0.425 ? 0.425 : (q < -0.425 ? -0.425 : q);
+        out[i] = ppfCentral(q);
+    }
+    for (size_t i = 0; i < n; ++i) {
+        const double q = p[i] - 0.5;
+        if (std::abs(q) > 0.425) out[i] = ppfTail(p[i], q);
+    }
+}
+
+// ERFC (W. J. Cody, CALERF)
+// |x| <= 0.46875:  erfc = 1 - x R1(x^2)
+// |x| <= 4:        erfc = e^{-x^2} R2(|x|)
+// |x| <= 26.543:   erfc = e^{-x^2} (1/sqrt(pi) - R3(1/x^2)/x^2) / |x|
+// x < 0:           erfc = 2 - erfc(|x|); дальше 26.543 результат денормализован
+// и считается std::erfc.
+namespace {
+const double kA[5] = {3.16112374387056560e00, 1.13864154151050156e02, 3.77485237685302021e02,
+                      3.20937758913846947e03, 1.85777706184603153e-1};
+const double kB[4] = {2.36012909523441209e01, 2.44024637934444173e02, 1.28261652607737228e03,
+                      2.84423683343917062e03};
+const double kC[9] = {5.64188496988670089e-1, 8.88314979438837594e00, 6.61191906371416295e01,
+                      2.98635138197400131e02, 8.81952221241769090e02, 1.71204761263407058e03,
+                      2.05107837782607147e03, 1.23033935479799725e03, 2.15311535474403846e-8};
+const double kD[8] = {1.57449261107098347e01, 1.17693950891312499e02, 5.37181101862009858e02,
+                      1.62138957456669019e03, 3.29079923573345963e03, 4.36261909014324716e03,
+                      3.43936767414372164e03, 1.23033935480374942e03};
+const double kP[6] = {3.05326634961232344e-1, 3.60344899949804439e-1, 1.25781726111229246e-1,
+                      1.60837851487422766e-2, 6.58749161529837803e-4, 1.63153871373020978e-2};
+const double kQ[5] = {2.56852019228982242e00, 1.87295284992346725e00, 5.27905102951428412e-1,
+                      6.05183413124413191e-2, 2.33520497626869185e-3};
+const double kSqrtPiInv = 5.6418958354775628695e-1;
+const double kThresh = 0.46875;
+const double kXBig = 26.543;
+const double kSqrt2 = 1.41421356237309504880;
+
+void erfc_batch_scalar(const double* x, double* out, double* ex, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        const double v = x[i];
+        out[i] = std::erfc(v);
+        if (ex) ex[i] = std::exp(-v * v);
+    }
+}
+}
+
+#ifdef SIMDEXP_X86
+
+// Все три области считаются для всех элементов и смешиваются масками:
+// без ветвлений дешевле, чем собирать элементы по областям
+__attribute__((target("avx2,fma")))
+static void erfc_batch_avx2(const double* x, double* out, double* ex, size_t n) {
+    const __m256d signMask = _mm256_set1_pd(-0.0), one = _mm256_set1_pd(1.0);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m256d v = _mm256_loadu_pd(x + i);
+        const __m256d y = _mm256_andnot_pd(signMask, v);
+        const __m256d y2 = _mm256_mul_pd(y, y);
+
+        __m256d xn = _mm256_mul_pd(_mm256_set1_pd(kA[4]), y2), xd = y2;
+        for (int j = 0; j < 3; ++j) {
+            xn = _mm256_mul_pd(_mm256_add_pd(xn, _mm256_set1_pd(kA[j])), y2);
+            xd = _mm256_mul_pd(_mm256_add_pd(xd, _mm256_set1_pd(kB[j])), y2);
+        }
+        const __m256d r1 = _mm256_fnmadd_pd(v, _mm256_div_pd(_mm256_add_pd(xn, _mm256_set1_pd(kA[3])),
+                                                             _mm256_add_pd(xd, _mm256_set1_pd(kB[3]))), one);
+
+        xn = _mm256_mul_pd(_mm256_set1_pd(kC[8]), y); xd = y;
+        for (int j = 0; j < 7; ++j) {
+            xn = _mm256_mul_pd(_mm256_add_pd(xn, _mm256_set1_pd(kC[j])), y);
+            xd = _mm256_mul_pd(_mm256_add_pd(xd, _mm256_set1_pd(kD[j])), y);
+        }
+        const __m256d r2 = _mm256_div_pd(_mm256_add_pd(xn, _mm256_set1_pd(kC[7])), _mm256_add_pd(xd, _mm256_set1_pd(kD[7])));
+
+        const __m256d iy2 = _mm256_div_pd(one, y2);
+        xn = _mm256_mul_pd(_mm256_set1_pd(kP[5]), iy2); xd = iy2;
+        for (int j = 0; j < 4; ++j) {
+            xn = _mm256_mul_pd(_mm256_add_pd(xn, _mm256_set1_pd(kP[j])), iy2);
+            xd = _mm256_mul_pd(_mm256_add_pd(xd, _mm256_set1_pd(kQ[j])), iy2);
+        }
+        __m256d r3 = _mm256_mul_pd(iy2, _mm256_div_pd(_mm256_add_pd(xn, _mm256_set1_pd(kP[4])),
+                                                      _mm256_add_pd(xd, _mm256_set1_pd(kQ[4]))));
+        r3 = _mm256_div_pd(_mm256_sub_pd(_mm256_set1_pd(kSqrtPiInv), r3), y);
+
+        // e^{-x^2} = e^{-hi} (1 - lo), x^2 = hi + lo точно
+        const __m256d lo = _mm256_fmsub_pd(y, y, y2);
+        const __m256d e = _mm256_mul_pd(exp_avx2(_mm256_sub_pd(_mm256_setzero_pd(), y2)), _mm256_sub_pd(one, lo));
+        if (ex) _mm256_storeu_pd(ex + i, e);
+        __m256d t = _mm256_mul_pd(e, _mm256_blendv_pd(r3, r2, _mm256_cmp_pd(y, _mm256_set1_pd(4.0), _CMP_LE_OQ)));
+        t = _mm256_blendv_pd(t, _mm256_sub_pd(_mm256_set1_pd(2.0), t), _mm256_cmp_pd(v, _mm256_setzero_pd(), _CMP_LT_OQ));
+        t = _mm256_blendv_pd(t, r1, _mm256_cmp_pd(y, _mm256_set1_pd(kThresh), _CMP_LE_OQ));
+        // Денормализованный хвост и NaN - поштучно (out может совпадать с x)
+        if (_mm256_movemask_pd(_mm256_cmp_pd(y, _mm256_set1_pd(kXBig), _CMP_NLE_UQ))) {
+            alignas(32) double in[4];
+            _mm256_store_pd(in, v);
+            _mm256_storeu_pd(out + i, t);
+            for (int j = 0; j < 4; ++j)
+                if (!(std::abs(in[j]) <= kXBig)) erfc_batch_scalar(in + j, out + i + j, ex ? ex + i + j : nullptr, 1);
+        } else {
+            _mm256_storeu_pd(out + i, t);
+        }
+    }
+    erfc_batch_scalar(x + i, out + i, ex ? ex + i : nullptr, n - i);
+}
+
+__attribute__((target("avx512f")))
+static void erfc_batch_avx512(const double* x, double* out, double* ex, size_t n) {
+    const __m512d one = _mm512_set1_pd(1.0);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m512d v = _mm512_loadu_pd(x + i);
+        const __m512d y = _mm512_abs_pd(v);
+        const __m512d y2 = _mm512_mul_pd(y, y);
+
+        __m512d xn = _mm512_mul_pd(_mm512_set1_pd(kA[4]), y2), xd = y2;
+        for (int j = 0; j < 3; ++j) {
+            xn = _mm512_mul_pd(_mm512_add_pd(xn, _mm512_set1_pd(kA[j])), y2);
+            xd = _mm512_mul_pd(_mm512_add_pd(xd, _mm512_set1_pd(kB[j])), y2);
+        }
+        const __m512d r1 = _mm512_fnmadd_pd(v, _mm512_div_pd(_mm512_add_pd(xn, _mm512_set1_pd(kA[3])),
+                                                             _mm512_add_pd(xd, _mm512_set1_pd(kB[3]))), one);
+
+        xn = _mm512_mul_pd(_mm512_set1_pd(kC[8]), y); xd = y;
+        for (int j = 0; j < 7; ++j) {
+            xn = _mm512_mul_pd(_mm512_add_pd(xn, _mm512_set1_pd(kC[j])), y);
+            xd = _mm512_mul_pd(_mm512_add_pd(xd, _mm512_set1_pd(kD[j])), y);
+        }
+        const __m512d r2 = _mm512_div_pd(_mm512_add_pd(xn, _mm512_set1_pd(kC[7])), _mm512_add_pd(xd, _mm512_set1_pd(kD[7])));
+
+        const __m512d iy2 = _mm512_div_pd(one, y2);
+        xn = _mm512_mul_pd(_mm512_set1_pd(kP[5]), iy2); xd = iy2;
+        for (int j = 0; j < 4; ++j) {
+            xn = _mm512_mul_pd(_mm512_add_pd(xn, _mm512_set1_pd(kP[j])), iy2);
+            xd = _mm512_mul_pd(_mm512_add_pd(xd, _mm512_set1_pd(kQ[j])), iy2);
+        }
+        __m512d r3 = _mm512_mul_pd(iy2, _mm512_div_pd(_mm512_add_pd(xn, _mm512_set1_pd(kP[4])),
+                                                      _mm512_add_pd(xd, _mm512_set1_pd(kQ[4]))));
+        r3 = _mm512_div_pd(_mm512_sub_pd(_mm512_set1_pd(kSqrtPiInv), r3), y);
+
+        const __m512d lo = _mm512_fmsub_pd(y, y, y2);
+        const __m512d e = _mm512_mul_pd(exp_avx512(_mm512_sub_pd(_mm512_setzero_pd(), y2)), _mm512_sub_pd(one, lo));
+        if (ex) _mm512_storeu_pd(ex + i, e);
+        __m512d t = _mm512_mul_pd(e, _mm512_mask_blend_pd(_mm512_cmp_pd_mask(y, _mm512_set1_pd(4.0), _CMP_LE_OQ), r3, r2));
+        t = _mm512_mask_blend_pd(_mm512_cmp_pd_mask(v, _mm512_setzero_pd(), _CMP_LT_OQ), t, _mm512_sub_pd(_mm512_set1_pd(2.0), t));
+        t = _mm512_mask_blend_pd(_mm512_cmp_pd_mask(y, _mm512_set1_pd(kThresh), _CMP_LE_OQ), t, r1);
+        const __mmask8 tail = _mm512_cmp_pd_mask(y, _mm512_set1_pd(kXBig), _CMP_NLE_UQ);
+        if (tail) {
+            alignas(64) double in[8];
+            _mm512_store_pd(in, v);
+            _mm512_storeu_pd(out + i, t);
+            for (int j = 0; j < 8; ++j)
+                if (tail & (1u << j)) erfc_batch_scalar(in + j, out + i + j, ex ? ex + i + j : nullptr, 1);
+        } else {
+            _mm512_storeu_pd(out + i, t);
+        }
+    }
+    erfc_batch_scalar(x + i, out + i, ex ? ex + i : nullptr, n - i);
+}
+
+#endif // SIMDEXP_X86
+
+namespace {
+typedef void (*ErfcFn)(const double*, double*, double*, size_t);
+
+struct ErfcChoice {
+    ErfcFn fn;
+    const char* name;
+};
+
+ErfcChoice chooseErfc() {
+#ifdef SIMDEXP_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return {&erfc_batch_avx512, "avx512"};
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return {&erfc_batch_avx2, "avx2"};
+#endif
+    return {&erfc_batch_scalar, "scalar"};
+}
+
+const ErfcChoice& erfcKernel() {
+    static const ErfcChoice k = chooseErfc();
+    return k;
+}
+}
+
+void erfc_batch(const double* x, double* out, size_t n) {
+    erfcKernel().fn(x, out, nullptr, n);
+}
+
+void erfc_exp_batch(const double* x, double* out, double* ex, size_t n) {
+    erfcKernel().fn(x, out, ex, n);
+}
+
+const char* erfc_kernel_name() {
+    return erfcKernel().name;
+}
+
+void norm_cdf_batch(const double* z, double* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) out[i] = -z[i] / kSqrt2;
+    erfc_batch(out, out, n);
+    for (size_t i = 0; i < n; ++i) out[i] *= 0.5;
+}
+
+void norm_sf_batch(const double* z, double* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) out[i] = z[i] / kSqrt2;
+    erfc_batch(out, out, n);
+    for (size_t i = 0; i < n; ++i) out[i] *= 0.5;
+}
+
+void norm_sf_pdf_batch(const double* z, double* sf, double* pdf, size_t n) {
+    for (size_t i = 0; i < n; ++i) sf[i] = z[i] / kSqrt2;
+    erfc_exp_batch(sf, sf, pdf, n);
+    for (size_t i = 0; i < n; ++i) {
+        sf[i] *= 0.5;
+        pdf[i] *= 0.39894228040143267794;
+    }
+}
@@ -0,0 +1,31 @@
+#ifndef NORMALDIST_H
+#define NORMALDIST_H
+
+#include <cstddef>
+
+// Квантиль стандартного нормального закона по AS241 (Wichura, PPND16),
+// относительная точность ~1e-16 на (0, 1). Без boost и без исключений.
+double norm_ppf_as241(double p);
+
+// Пакетный вариант: центральная область |p - 0.5| <= 0.425 (рациональная
+// функция без log/sqrt) считается отдельным плотным циклом, который
+// компилятор векторизует; хвосты - поштучно.
+void norm_ppf_batch(const double* p, double* out, size_t n);
+
+// erfc по рациональным приближениям Коди (CALERF), относительная точность
+// ~1e-15 везде, где результат не денормализован; exp(-x^2) берется от
+// точного x^2 = hi + lo (FMA). Реализация (AVX-512 / AVX2+FMA / скалярная)
+// выбирается один раз по процессору, как в weibull_sums. out может совпадать с x.
+void erfc_batch(const double* x, double* out, size_t n);
+// То же и заодно ex[i] = exp(-x[i]^2): в ядре она считается все равно
+void erfc_exp_batch(const double* x, double* out, double* ex, size_t n);
+const char* erfc_kernel_name();
+
+// Ф(z) = erfc(-z/sqrt 2)/2 и Q(z) = 1 - Ф(z) = erfc(z/sqrt 2)/2 - та же формула,
+// что в boost::math::cdf(normal), поэтому хвосты совпадают с boost до ~1e-15
+void norm_cdf_batch(const double* z, double* out, size_t n);
+void norm_sf_batch(const double* z, double* out, size_t n);
+// Q(z) и плотность ф(z) за один проход (правдоподобие цензурированных)
+void norm_sf_pdf_batch(const double* z, double* sf, double* pdf, size_t n);
+
+#endif // NORMALDIST_H
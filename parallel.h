@@ -0,0 +1,48 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include "runcontrol.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+inline unsigned default_thread_count() {
+    unsigned n = std::thread::hardware_concurrency();
+    return n ? n : 1;
+}
+
+// Параллельный цикл по [0, count): body(i, worker), worker в [0, threads).
+// Задания раздаются динамически через атомарный счетчик, поэтому неравные по
+// стоимости элементы (файлы разного размера) не тормозят остальные потоки.
+// body не должна бросать исключения. Рабочие потоки получают контроль
+// расчета вызывающего (currentRunControl): FitContext, созданный внутри
+// body, видит ту же отмену, что и последовательный расчет.
+template <class Body>
+void parallel_for(size_t count, unsigned threads, Body&& body) {
+    if (threads == 0) threads = default_thread_count();
+    if (threads > count) threads = static_cast<unsigned>(std::max<size_t>(count, 1));
+    if (threads <= 1) {
+        for (size_t i = 0; i < count; ++i) body(i, 0u);
+        return;
+    }
+
+    std::atomic<size_t> next{0};
+    RunControl* const control = currentRunControl();
+    auto worker = [&](unsigned w) {
+        RunControlScope scope(control);
+        for (size_t i = next.fetch_add(1, std::memory_order_relaxed); i < count;
+             i = next.fetch_add(1, std::memory_order_relaxed)) {
+            body(i, w);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(threads - 1);
+    for (unsigned w = 1; w < threads; ++w) pool.emplace_back(worker, w);
+    worker(0);
+    for (auto& t : pool) t.join();
+}
+
+#endif // PARALLEL_H
@@ -0,0 +1,159 @@
+#include "plotlod.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+
+// Ниже стольких видимых точек на пиксель ширины серия рисуется целиком
+static const size_t kDirectPerPixel = 2;
+// Точек облака после прореживания на пиксель ширины (плюс не больше одной
+// на занятую ячейку из-за округления вверх)
+static const size_t kScatterPerPixel = 64;
+
+LodSeries::LodSeries(const GraphSeriesData& data, bool logX_)
+    : scatter(data.isScatter), logX(logX_), sorted(true)
+{
+    size_t n = std::min(data.x.size(), data.y.size());
+    x.reserve(n); y.reserve(n); u.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        // На логарифмической оси x <= 0 не изображается
+        if (logX && !(data.x[i] > 0)) continue;
+        x.push_back(data.x[i]);
+        y.push_back(data.y[i]);
+        u.push_back(logX ? std::log10(data.x[i]) : data.x[i]);
+    }
+    sorted = std::is_sorted(u.begin(), u.end());
+
+    // Порядок точек на рисунке не важен - упорядочиваем ради бинарного поиска.
+    // Линию переставлять нельзя: она прореживается проходом по порядку.
+    if (scatter && !sorted) {
+        std::vector<size_t> order(u.size());
+        std::iota(order.begin(), order.end(), size_t(0));
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return u[a] < u[b]; });
+        std::vector<double> nu(u.size()), nx(u.size()), ny(u.size());
+        for (size_t i = 0; i < order.size(); ++i) {
+            nu[i] = u[order[i]]; nx[i] = x[order[i]]; ny[i] = y[order[i]];
+        }
+        u.swap(nu); x.swap(nx); y.swap(ny);
+        sorted = true;
+    }
+}
+
+void LodSeries::decimate(const PlotViewport& view, std::vector<double>& xs, std::vector<double>& ys) const {
+    xs.clear(); ys.clear();
+    const size_t n = u.size();
+    double u0 = logX ? std::log10(view.xMin) : view.xMin;
+    double u1 = logX ? std::log10(view.xMax) : view.xMax;
+
+    size_t lo = 0, hi = n;
+    if (sorted && u1 > u0) {
+        lo = std::lower_bound(u.begin(), u.end(), u0) - u.begin();
+        hi = std::upper_bound(u.begin(), u.end(), u1) - u.begin();
+        // Линия захватывает соседей за краями, чтобы отрезки доходили до рамки
+        if (!scatter) {
+            if (lo > 0) --lo;
+            if (hi < n) ++hi;
+        }
+    }
+
+    const size_t width = static_cast<size_t>(std::max(1, view.width));
+    bool degenerate = !(u1 > u0) || !(view.yMax > view.yMin) || view.height < 1;
+    if (degenerate || hi - lo <= kDirectPerPixel * width) {
+        xs.assign(x.begin() + lo, x.begin() + hi);
+        ys.assign(y.begin() + lo, y.begin() + hi);
+        return;
+    }
+    if (scatter) decimateScatter(view, lo, hi, xs, ys);
+    else decimateLine(view, lo, hi, xs, ys);
+}
+
+void LodSeries::decimateLine(const PlotViewport& view, size_t lo, size_t hi,
+                             std::vector<double>& xs, std::vector<double>& ys) const {
+    double u0 = logX ? std::log10(view.xMin) : view.xMin;
+    double u1 = logX ? std::log10(view.xMax) : view.xMax;
+    const double scale = view.width / (u1 - u0);
+    const long last = view.width;
+    xs.reserve(4 * (view.width + 2));
+    ys.reserve(4 * (view.width + 2));
+
+    // Столбец: первая, min, max, последняя точки в порядке следования
+    auto column = [&](size_t i) {
+        double c = std::floor((u[i] - u0) * scale);
+        return static_cast<long>(std::min<double>(std::max<double>(c, -1.0), double(last)));
+    };
+    auto flush = [&](size_t first, size_t imin, size_t imax, size_t end) {
+        size_t idx[4] = {first, imin, imax, end};
+        std::sort(idx, idx + 4);
+        for (int k = 0; k < 4; ++k) {
+            if (k && idx[k] == idx[k - 1]) continue;
+            xs.push_back(x[idx[k]]);
+            ys.push_back(y[idx[k]]);
+        }
+    };
+
+    size_t first = lo, imin = lo, imax = lo;
+    long col = column(lo);
+    for (size_t i = lo + 1; i < hi; ++i) {
+        long c = column(i);
+        if (c != col) {
+            flush(first, imin, imax, i - 1);
+            first = imin = imax = i;
+            col = c;
+            continue;
+        }
+        if (y[i] < y[imin]) imin = i;
+        if (y[i] > y[imax]) imax = i;
+    }
+    flush(first, imin, imax, hi - 1);
+}
+
+void LodSeries::decimateScatter(const PlotViewport& view, size_t lo, size_t hi,
+                                std::vector<double>& xs, std::vector<double>& ys) const {
+    double u0 = logX ? std::log10(view.xMin) : view.xMin;
+    double u1 = logX ? std::log10(view.xMax) : view.xMax;
+    const int cell = std::max(1, view.cellPx);
+    const long cols = (view.width + cell - 1) / cell;
+    const long rows = (view.height + cell - 1) / cell;
+    const double sx = cols / (u1 - u0);
+    const double sy = rows / (view.yMax - view.yMin);
+
+    // Ячейка точки; -1 - вне области или NaN
+    auto cellOf = [&](size_t i) -> long {
+        double cx = (u[i] - u0) * sx, cy = (y[i] - view.yMin) * sy;
+        if (!(cx >= 0 && cx <= cols && cy >= 0 && cy <= rows)) return -1;
+        long ix = std::min(static_cast<long>(cx), cols - 1);
+        long iy = std::min(static_cast<long>(cy), rows - 1);
+        return iy * cols + ix;
+    };
+
+    // Первый проход - ячейки точек и число точек в ячейках
+    std::vector<uint32_t> count(static_cast<size_t>(cols * rows), 0);
+    std::vector<int32_t> cellIdx(hi - lo);
+    size_t visible = 0;
+    for (size_t i = lo; i < hi; ++i) {
+        long c = cellOf(i);
+        cellIdx[i - lo] = static_cast<int32_t>(c);
+        if (c < 0) continue;
+        ++count[static_cast<size_t>(c)];
+        ++visible;
+    }
+    if (visible == 0) return;
+
+    // Второй - из ячейки с count точками остается keep = ceil(count * budget / visible),
+    // равномерно по порядку x (Брезенхем), так что плотность облака сохраняется,
+    // а одиночные точки и выбросы не теряются
+    const double share = static_cast<double>(kScatterPerPixel * view.width) / visible;
+    std::vector<uint32_t> seen(count.size(), 0);
+    xs.reserve(kScatterPerPixel * view.width);
+    ys.reserve(kScatterPerPixel * view.width);
+    for (size_t i = lo; i < hi; ++i) {
+        long c = cellIdx[i - lo];
+        if (c < 0) continue;
+        const uint64_t total = count[static_cast<size_t>(c)];
+        const uint64_t keep = std::min<uint64_t>(total, static_cast<uint64_t>(std::ceil(total * share)));
+        const uint64_t s = seen[static_cast<size_t>(c)]++;
+        if ((s + 1) * keep / total == s * keep / total) continue;
+        xs.push_back(x[i]);
+        ys.push_back(y[i]);
+    }
+}
@@ -0,0 +1,52 @@
+#ifndef PLOTLOD_H
+#define PLOTLOD_H
+
+#include "AbstractMethod.h"
+#include <cstddef>
+#include <vector>
+
+// Уровни детализации для графиков с миллионами точек. Серия один раз
+// готовится (x переводится в шкалу оси и упорядочивается), затем при каждом
+// изменении видимой области прореживается до числа точек порядка числа
+// пикселей:
+//  - линия: по столбцам пикселей первая, минимальная, максимальная и
+//    последняя точки (огибающая min/max, изгибы и выбросы сохраняются);
+//  - точки: выборка по ячейкам cellPx x cellPx пикселей пропорционально
+//    числу точек в ячейке (около 64 точек на пиксель ширины в сумме), так что
+//    густые области остаются гуще редких, а в каждой занятой ячейке
+//    остается хотя бы одна точка - выбросы не пропадают.
+// Пока видимых точек меньше порога, серия отдается без прореживания.
+
+struct PlotViewport {
+    double xMin = 0, xMax = 1;    // в единицах данных (не логарифмах)
+    double yMin = 0, yMax = 1;
+    bool logX = false;            // ось x логарифмическая
+    int width = 800;              // размер области построения, пикселей
+    int height = 600;
+    int cellPx = 2;               // ячейка прореживания точек
+};
+
+class LodSeries {
+public:
+    LodSeries(const GraphSeriesData& data, bool logX);
+
+    // Точки для отрисовки в области view (в единицах данных)
+    void decimate(const PlotViewport& view, std::vector<double>& xs, std::vector<double>& ys) const;
+
+    size_t size() const { return x.size(); }
+    bool isScatter() const { return scatter; }
+
+private:
+    void decimateLine(const PlotViewport& view, size_t lo, size_t hi,
+                      std::vector<double>& xs, std::vector<double>& ys) const;
+    void decimateScatter(const PlotViewport& view, size_t lo, size_t hi,
+                         std::vector<double>& xs, std::vector<double>& ys) const;
+
+    std::vector<double> u;        // x в шкале оси (log10 при logX)
+    std::vector<double> x, y;
+    bool scatter;
+    bool logX;
+    bool sorted;                  // u не убывает: видимый диапазон - бинарным поиском
+};
+
+#endif // PLOTLOD_H
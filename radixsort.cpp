@@ -0,0 +1,178 @@
+#include "radixsort.h"
+#include "parallel.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+
+static const int kDigitBits = 11;
+static const int kPasses = 6;                      // 65 бит ключа (x + признак) по 11
+static const size_t kBuckets = size_t(1) << kDigitBits;
+static const uint64_t kDigitMask = kBuckets - 1;
+static const uint64_t kSign = uint64_t(1) << 63;
+static const size_t kSmallN = 2048;                // ниже сравнение быстрее (замер sort_order)
+static const size_t kParallelMin = size_t(1) << 18;
+static const size_t kMinPerThread = size_t(1) << 16;
+
+static std::atomic<unsigned> g_sortThreads{0};
+
+void set_radix_sort_threads(unsigned threads) {
+    g_sortThreads.store(threads, std::memory_order_relaxed);
+}
+
+unsigned radix_sort_threads() {
+    return g_sortThreads.load(std::memory_order_relaxed);
+}
+
+static unsigned effectiveThreads(unsigned threads, size_t n) {
+    if (n < kParallelMin) return 1;
+    unsigned t = threads ? threads : radix_sort_threads();
+    if (t == 0) t = default_thread_count();
+    return static_cast<unsigned>(std::max<size_t>(1, std::min<size_t>(t, n / kMinPerThread)));
+}
+
+static inline uint64_t orderedBits(double v) {
+    if (v == 0.0) v = 0.0; // -0 и +0 - один ключ
+    uint64_t u;
+    std::memcpy(&u, &v, sizeof(u));
+    return (u & kSign) ? ~u : (u | kSign);
+}
+
+static inline double fromOrderedBits(uint64_t u) {
+    u = (u & kSign) ? (u & ~kSign) : ~u;
+    double v;
+    std::memcpy(&v, &u, sizeof(v));
+    return v;
+}
+
+// Разряд pass 65-битного ключа (биты x, затем признак из старшего бита номера)
+template <class Idx>
+static inline size_t digitOf(uint64_t key, Idx idx, int pass) {
+    const int flagShift = static_cast<int>(sizeof(Idx) * 8 - 1);
+    if (pass == 0) return static_cast<size_t>(((key << 1) | static_cast<uint64_t>(idx >> flagShift)) & kDigitMask);
+    return static_cast<size_t>((key >> (kDigitBits * pass - 1)) & kDigitMask);
+}
+
+// Проходы LSD. Записи делятся на threads непрерывных блоков; у каждого блока
+// свои счетчики корзин, смещения идут по (корзина, блок), поэтому раскладка
+// остается устойчивой и блоки пишут без синхронизации. fill(i) заполняет
+// key[i]/idx[i] в том же проходе, что и счетчики всех разрядов.
+// idx == nullptr - сортируются только ключи. На выходе key/idx указывают на
+// отсортированный буфер.
+template <class Idx, class Fill>
+static void radixPasses(uint64_t*& key, uint64_t*& keyTmp, Idx*& idx, Idx*& idxTmp,
+                        size_t n, unsigned threads, Fill fill) {
+    const size_t T = threads;
+    auto blockBegin = [&](size_t b) { return b * n / T; };
+    auto digit = [&](size_t i, int p) { return digitOf(key[i], idx ? idx[i] : Idx(0), p); };
+
+    std::vector<size_t> cnt(T * kPasses * kBuckets, 0);
+    parallel_for(T, threads, [&](size_t b, unsigned) {
+        size_t* h = &cnt[b * kPasses * kBuckets];
+        for (size_t i = blockBegin(b), e = blockBegin(b + 1); i < e; ++i) {
+            fill(i);
+            for (int p = 0; p < kPasses; ++p) ++h[p * kBuckets + digit(i, p)];
+        }
+    });
+
+    std::vector<size_t> offs(T * kBuckets);
+    bool moved = false;
+    for (int p = 0; p < kPasses; ++p) {
+        // Сумма по блокам от перестановок не зависит: все в одной корзине - проход не нужен
+        const size_t d0 = digit(0, p);
+        size_t same = 0;
+        for (size_t b = 0; b < T; ++b) same += cnt[(b * kPasses + p) * kBuckets + d0];
+        if (same == n) continue;
+
+        if (moved && T > 1) {
+            // После раскладки в блоках другие записи - счетчики блока заново
+            parallel_for(T, threads, [&](size_t b, unsigned) {
+                size_t* h = &cnt[(b * kPasses + p) * kBuckets];
+                std::fill(h, h + kBuckets, size_t(0));
+                for (size_t i = blockBegin(b), e = blockBegin(b + 1); i < e; ++i) ++h[digit(i, p)];
+            });
+        }
+
+        size_t run = 0;
+        for (size_t d = 0; d < kBuckets; ++d) {
+            for (size_t b = 0; b < T; ++b) {
+                offs[b * kBuckets + d] = run;
+                run += cnt[(b * kPasses + p) * kBuckets + d];
+            }
+        }
+
+        parallel_for(T, threads, [&](size_t b, unsigned) {
+            size_t* o = &offs[b * kBuckets];
+            for (size_t i = blockBegin(b), e = blockBegin(b + 1); i < e; ++i) {
+                size_t pos = o[digit(i, p)]++;
+                keyTmp[pos] = key[i];
+                if (idx) idxTmp[pos] = idx[i];
+            }
+        });
+        std::swap(key, keyTmp);
+        std::swap(idx, idxTmp);
+        moved = true;
+    }
+}
+
+template <class Idx>
+static void sortOrder(DataView x, CensView flags, std::vector<size_t>& order, unsigned threads) {
+    const size_t n = x.size();
+    const int flagShift = static_cast<int>(sizeof(Idx) * 8 - 1);
+    const Idx flagBit = Idx(1) << flagShift;
+    const bool hasFlags = !flags.empty();
+
+    std::vector<uint64_t> keys(2 * n);
+    std::vector<Idx> ids(2 * n);
+    uint64_t* key = keys.data();
+    uint64_t* keyTmp = key + n;
+    Idx* idx = ids.data();
+    Idx* idxTmp = idx + n;
+    radixPasses(key, keyTmp, idx, idxTmp, n, threads, [&](size_t i) {
+        key[i] = orderedBits(x[i]);
+        idx[i] = static_cast<Idx>(i) | (hasFlags && flags[i] != 0 ? flagBit : Idx(0));
+    });
+
+    const Idx* sorted = idx;
+    parallel_for(threads, threads, [&](size_t b, unsigned) {
+        for (size_t i = b * n / threads, e = (b + 1) * n / threads; i < e; ++i)
+            order[i] = static_cast<size_t>(sorted[i] & ~flagBit);
+    });
+}
+
+void radix_sort_order(DataView x, CensView flags, std::vector<size_t>& order, unsigned threads) {
+    const size_t n = x.size();
+    order.resize(n);
+    if (n < kSmallN) {
+        const bool hasFlags = !flags.empty();
+        std::iota(order.begin(), order.end(), size_t(0));
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return x[a] < x[b] || (x[a] == x[b] && hasFlags && flags[a] == 0 && flags[b] != 0);
+        });
+        return;
+    }
+    // Номер с признаком в старшем бите: 32 бита, пока хватает, - меньше памяти на проход
+    const unsigned t = effectiveThreads(threads, n);
+    if (n < (size_t(1) << 31)) sortOrder<uint32_t>(x, flags, order, t);
+    else sortOrder<uint64_t>(x, flags, order, t);
+}
+
+void radix_sort(double* x, size_t n, unsigned threads) {
+    if (n < kSmallN) {
+        std::sort(x, x + n);
+        return;
+    }
+    const unsigned t = effectiveThreads(threads, n);
+    std::vector<uint64_t> keys(2 * n);
+    uint64_t* key = keys.data();
+    uint64_t* keyTmp = key + n;
+    uint32_t* idx = nullptr;
+    uint32_t* idxTmp = nullptr;
+    radixPasses(key, keyTmp, idx, idxTmp, n, t, [&](size_t i) { key[i] = orderedBits(x[i]); });
+
+    const uint64_t* sorted = key;
+    parallel_for(t, t, [&](size_t b, unsigned) {
+        for (size_t i = b * n / t, e = (b + 1) * n / t; i < e; ++i) x[i] = fromOrderedBits(sorted[i]);
+    });
+}
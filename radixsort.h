@@ -0,0 +1,30 @@
+#ifndef RADIXSORT_H
+#define RADIXSORT_H
+
+#include "sampleview.h"
+#include <cstddef>
+#include <vector>
+
+// Поразрядная (LSD) сортировка чисел double по битам IEEE-754.
+// Значение переводится в uint64 с сохранением порядка (у положительных
+// инвертируется знаковый бит, у отрицательных - все биты, -0 приводится к +0).
+// Признак (цензура, номер группы) едет в старшем бите номера записи и служит
+// младшим, 65-м разрядом ключа: при равных x записи с признаком 0 идут первыми.
+// Проходы по 11 бит; проход, в котором все ключи попадают в одну корзину
+// (обычно старшие биты экспоненты), пропускается. До 2048 записей -
+// std::stable_sort: там сравнение быстрее.
+
+// Перестановка по возрастанию (x, flags[i] != 0); сортировка устойчивая.
+// threads == 0 - значение set_radix_sort_threads.
+void radix_sort_order(DataView x, CensView flags, std::vector<size_t>& order, unsigned threads = 0);
+
+// Сортировка значений на месте
+void radix_sort(double* x, size_t n, unsigned threads = 0);
+
+// Потоки по умолчанию для выборок от 2^18 записей: 0 - по числу ядер.
+// Пакетный режим с несколькими файлами ставит 1, чтобы не плодить потоки
+// внутри уже параллельных заданий.
+void set_radix_sort_threads(unsigned threads);
+unsigned radix_sort_threads();
+
+#endif // RADIXSORT_H
@@ -0,0 +1,180 @@
+#include "ranksum.h"
+#include "runcontrol.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <utility>
+
+static thread_local size_t g_lastWorkBytes = 0;
+
+RankSumDistribution::RankSumDistribution(long long base2_, int step2_, std::vector<double> pmf)
+    : base2(base2_), step2(step2_), lower(pmf.size()), upper(pmf.size()) {
+    double acc = 0;
+    for (size_t k = 0; k < pmf.size(); ++k) { acc += pmf[k]; lower[k] = std::min(acc, 1.0); }
+    acc = 0;
+    for (size_t k = pmf.size(); k-- > 0;) { acc += pmf[k]; upper[k] = std::min(acc, 1.0); }
+}
+
+long long RankSumDistribution::indexBelow(double w) const {
+    return static_cast<long long>(std::floor((2.0 * w - static_cast<double>(base2)) / step2 + 1e-9));
+}
+
+double RankSumDistribution::cdf(double w) const {
+    long long k = indexBelow(w);
+    if (k < 0) return 0.0;
+    if (k >= static_cast<long long>(lower.size())) return 1.0;
+    return lower[static_cast<size_t>(k)];
+}
+
+double RankSumDistribution::sf(double w) const {
+    long long k = static_cast<long long>(std::ceil((2.0 * w - static_cast<double>(base2)) / step2 - 1e-9));
+    if (k <= 0) return 1.0;
+    if (k >= static_cast<long long>(upper.size())) return 0.0;
+    return upper[static_cast<size_t>(k)];
+}
+
+double RankSumDistribution::pValue(double w) const {
+    return std::min(1.0, 2.0 * std::min(cdf(w), sf(w)));
+}
+
+double RankSumDistribution::lowerCritical(double a) const {
+    long long k = -1;
+    while (k + 1 < static_cast<long long>(lower.size()) && lower[static_cast<size_t>(k + 1)] <= a) ++k;
+    return static_cast<double>(base2 + k * step2) / 2.0;
+}
+
+double RankSumDistribution::upperCritical(double a) const {
+    long long k = static_cast<long long>(upper.size());
+    while (k > 0 && upper[static_cast<size_t>(k - 1)] <= a) --k;
+    return static_cast<double>(base2 + k * step2) / 2.0;
+}
+
+// Длина f[i] на шаге j - обрезанный носитель U
+static size_t untiedLen(int i, int j, long long K) {
+    return static_cast<size_t>(std::min<long long>(static_cast<long long>(i) * j, K)) + 1;
+}
+
+static std::shared_ptr<const RankSumDistribution> computeUntied(int m, int n, RunControl* control) {
+    // f[i] - распределение U для (i, j) на текущем j, обрезанное до половины носителя
+    const long long K = static_cast<long long>(m) * n / 2;
+    std::vector<std::vector<double>> f(static_cast<size_t>(m) + 1, std::vector<double>(1, 1.0));
+    size_t peak = 0;
+
+    // Прогресс - по доле пройденных ячеек: столбцы растут, пока не упрутся в K
+    double cells = 0, done = 0;
+    if (control)
+        for (int j = 1; j <= n; ++j)
+            for (int i = 1; i <= m; ++i) cells += static_cast<double>(untiedLen(i, j, K));
+
+    for (int j = 1; j <= n; ++j) {
+        if (control) {
+            if (control->cancelled()) return nullptr;
+            control->setProgress(cells > 0 ? done / cells : 0.0);
+        }
+        size_t live = 0;
+        for (int i = 1; i <= m; ++i) {
+            std::vector<double>& cur = f[static_cast<size_t>(i)];
+            const std::vector<double>& prev = f[static_cast<size_t>(i) - 1];
+            const double a = static_cast<double>(i) / (i + j), b = static_cast<double>(j) / (i + j);
+            size_t len = untiedLen(i, j, K);
+            cur.resize(len, 0.0);
+            done += static_cast<double>(len);
+            size_t shift = static_cast<size_t>(j);
+            for (size_t u = 0; u < std::min(shift, len); ++u) cur[u] *= b;
+            for (size_t u = shift; u < len; ++u)
+                cur[u] = b * cur[u] + (u - shift < prev.size() ? a * prev[u - shift] : 0.0);
+            live += cur.capacity();
+        }
+        peak = std::max(peak, live);
+    }
+    g_lastWorkBytes = peak * sizeof(double);
+
+    const size_t total = static_cast<size_t>(m) * n + 1;
+    const std::vector<double>& half = f[static_cast<size_t>(m)];
+    std::vector<double> pmf(total, 0.0);
+    for (size_t u = 0; u < half.size(); ++u) {
+        pmf[u] = half[u];
+        pmf[total - 1 - u] = half[u];
+    }
+    return std::make_shared<const RankSumDistribution>(static_cast<long long>(m) * (m + 1), 2, std::move(pmf));
+}
+
+std::shared_ptr<const RankSumDistribution> rank_sum_exact(int m, int n, RunControl* control) {
+    if (m < 0 || n < 0) return nullptr;
+    static std::mutex mu;
+    static std::map<std::pair<int, int>, std::shared_ptr<const RankSumDistribution>> cache;
+    const std::pair<int, int> key(m, n);
+    {
+        std::lock_guard<std::mutex> lock(mu);
+        auto it = cache.find(key);
+        if (it != cache.end()) return it->second;
+    }
+
+    // Считаем вне блокировки: другие (m, n) не ждут; при гонке победит первый
+    std::shared_ptr<const RankSumDistribution> d = computeUntied(m, n, control);
+    if (!d) return nullptr;   // отменен - в кеш не попадает
+    std::lock_guard<std::mutex> lock(mu);
+    if (cache.size() >= 64) cache.clear();
+    return cache.emplace(key, d).first->second;
+}
+
+std::shared_ptr<const RankSumDistribution> rank_sum_exact_ties(int m, const std::vector<int>& tieSizes,
+                                                               RunControl* control) {
+    int N = 0;
+    for (int t : tieSizes) N += t;
+    if (m < 0 || m > N) return nullptr;
+
+    // c[k][s]: число способов выбрать k элементов с суммой удвоенных рангов s
+    const long long maxSum = 2LL * N * m;
+    const size_t S = static_cast<size_t>(maxSum) + 1;
+    std::vector<std::vector<double>> c(static_cast<size_t>(m) + 1, std::vector<double>(S, 0.0));
+    c[0][0] = 1.0;
+    g_lastWorkBytes = c.size() * S * sizeof(double);
+
+    std::vector<double> binom;
+    int seen = 0, start = 1;
+    for (int t : tieSizes) {
+        if (control) {
+            if (control->cancelled()) return nullptr;
+            control->setProgress(static_cast<double>(seen) / N);
+        }
+        const long long v = start + (start + t - 1); // удвоенный средний ранг группы
+        binom.assign(static_cast<size_t>(t) + 1, 1.0);
+        for (int a = 1; a <= t; ++a) binom[static_cast<size_t>(a)] = binom[static_cast<size_t>(a) - 1] * (t - a + 1) / a;
+
+        for (int k = std::min(m, seen + t); k >= 1; --k) {
+            std::vector<double>& dst = c[static_cast<size_t>(k)];
+            for (int a = 1; a <= std::min(t, k); ++a) {
+                const std::vector<double>& src = c[static_cast<size_t>(k - a)];
+                const size_t off = static_cast<size_t>(a * v);
+                const double w = binom[static_cast<size_t>(a)];
+                for (size_t s = off; s < S; ++s) dst[s] += w * src[s - off];
+            }
+        }
+        seen += t;
+        start += t;
+    }
+
+    std::vector<double>& top = c[static_cast<size_t>(m)];
+    double total = 0;
+    for (double v : top) total += v;
+    size_t lo = 0, hi = S;
+    while (lo < hi && top[lo] == 0.0) ++lo;
+    while (hi > lo && top[hi - 1] == 0.0) --hi;
+    std::vector<double> pmf(top.begin() + static_cast<std::ptrdiff_t>(lo), top.begin() + static_cast<std::ptrdiff_t>(hi));
+    for (double& v : pmf) v /= total;
+    return std::make_shared<const RankSumDistribution>(static_cast<long long>(lo), 1, std::move(pmf));
+}
+
+bool rank_sum_exact_feasible(int m, int n, const std::vector<int>& tieSizes) {
+    const double mm = std::min(m, n), nn = std::max(m, n), N = mm + nn;
+    bool ties = false;
+    for (int t : tieSizes) if (t > 1) ties = true;
+    if (!ties) return mm * mm * nn * nn / 8.0 <= 5e8;
+    return N * mm * 2.0 * N * mm <= 1e9;
+}
+
+size_t rank_sum_last_work_bytes() {
+    return g_lastWorkBytes;
+}
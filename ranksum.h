@@ -0,0 +1,59 @@
+#ifndef RANKSUM_H
+#define RANKSUM_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+class RunControl;   // runcontrol.h
+
+// Точное нулевое распределение суммы рангов W выборки объема m
+// среди m + n наблюдений. Значения W хранятся в удвоенном виде (2W целое),
+// чтобы средние ранги при совпадениях тоже попадали в сетку.
+class RankSumDistribution {
+public:
+    RankSumDistribution(long long base2, int step2, std::vector<double> pmf);
+
+    double cdf(double w) const;   // P(W <= w)
+    double sf(double w) const;    // P(W >= w)
+    double pValue(double w) const; // двусторонний: 2 * min(cdf, sf), не больше 1
+
+    // Наибольшее w с P(W <= w) <= a и наименьшее w с P(W >= w) <= a
+    // (если таких нет - на шаг за пределами носителя)
+    double lowerCritical(double a) const;
+    double upperCritical(double a) const;
+
+    size_t bytes() const { return (lower.size() + upper.size()) * sizeof(double); }
+
+private:
+    long long base2;            // 2W первого узла
+    int step2;                  // шаг сетки в единицах 2W
+    std::vector<double> lower;  // P(W <= w_k)
+    std::vector<double> upper;  // P(W >= w_k) - хвосты без вычитания из единицы
+
+    long long indexBelow(double w) const;
+};
+
+// Без совпадений: распределение зависит только от (m, n) и кешируется.
+// Счет - рекурсия по вероятностям U = W - m(m+1)/2:
+// p(i,j,u) = i/(i+j) p(i-1,j,u-j) + j/(i+j) p(i,j-1,u), только сложения
+// положительных чисел, поэтому точны и дальние хвосты. Из-за симметрии
+// считается только половина носителя. Время ~ m^2 n^2 / 8.
+// control - отмена и прогресс по столбцам рекурсии; отмененный расчет
+// возвращает nullptr и в кеш не попадает.
+std::shared_ptr<const RankSumDistribution> rank_sum_exact(int m, int n, RunControl* control = nullptr);
+
+// С совпадениями: условное распределение при данных размерах групп
+// (в порядке возрастания значений). Подмножества считаются по группам:
+// из группы размера t берется k элементов C(t, k) способами.
+// control - как у rank_sum_exact, прогресс по группам совпадений.
+std::shared_ptr<const RankSumDistribution> rank_sum_exact_ties(int m, const std::vector<int>& tieSizes,
+                                                               RunControl* control = nullptr);
+
+// Укладывается ли точный счет в разумное время (порядка секунды)
+bool rank_sum_exact_feasible(int m, int n, const std::vector<int>& tieSizes);
+
+// Пиковый объем рабочих таблиц последнего расчета в текущем потоке, байт
+size_t rank_sum_last_work_bytes();
+
+#endif // RANKSUM_H
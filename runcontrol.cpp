@@ -0,0 +1,17 @@
+#include "runcontrol.h"
+
+namespace {
+thread_local RunControl* tlsControl = nullptr;
+}
+
+RunControl* currentRunControl() {
+    return tlsControl;
+}
+
+RunControlScope::RunControlScope(RunControl* control) : prev(tlsControl) {
+    tlsControl = control;
+}
+
+RunControlScope::~RunControlScope() {
+    tlsControl = prev;
+}
@@ -0,0 +1,41 @@
+#ifndef RUNCONTROL_H
+#define RUNCONTROL_H
+
+#include <atomic>
+
+// Управление долгим расчетом из другого потока (окно программы): запрос
+// отмены и доля выполненной работы. Оценки проверяют отмену в своих
+// итерациях и выходят досрочно; результат отмененного расчета не нужен
+// и отбрасывается вызывающим, поэтому исключения не используются.
+class RunControl {
+public:
+    void cancel() { stop.store(true, std::memory_order_relaxed); }
+    bool cancelled() const { return stop.load(std::memory_order_relaxed); }
+
+    // 0..1; отрицательное значение - прогресс неизвестен
+    void setProgress(double p) { prog.store(p, std::memory_order_relaxed); }
+    double progress() const { return prog.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<bool> stop{false};
+    std::atomic<double> prog{-1.0};
+};
+
+// Контроль расчета, назначенный текущему потоку (nullptr - расчет без отмены).
+// FitContext запоминает его при создании, поэтому сигнатуры методов и
+// оценок не меняются.
+RunControl* currentRunControl();
+
+// Назначает контроль потоку на время жизни объекта
+class RunControlScope {
+public:
+    explicit RunControlScope(RunControl* control);
+    ~RunControlScope();
+    RunControlScope(const RunControlScope&) = delete;
+    RunControlScope& operator=(const RunControlScope&) = delete;
+
+private:
+    RunControl* prev;
+};
+
+#endif // RUNCONTROL_H
@@ -0,0 +1,73 @@
+#ifndef SAMPLEVIEW_H
+#define SAMPLEVIEW_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Невладеющее представление непрерывного массива (аналог std::span из C++20).
+// Неявно строится из std::vector, поэтому старые вызовы с векторами работают как раньше.
+template <class T>
+class ArrayView {
+public:
+    ArrayView() {}
+    ArrayView(const T* p, size_t n) : ptr(p), len(n) {}
+    ArrayView(const std::vector<T>& v) : ptr(v.data()), len(v.size()) {}
+
+    const T* data() const { return ptr; }
+    size_t size() const { return len; }
+    bool empty() const { return len == 0; }
+    const T& operator[](size_t i) const { return ptr[i]; }
+    const T* begin() const { return ptr; }
+    const T* end() const { return ptr + len; }
+    const T& front() const { return ptr[0]; }
+    const T& back() const { return ptr[len - 1]; }
+    std::vector<T> toVector() const { return std::vector<T>(ptr, ptr + len); }
+
+private:
+    const T* ptr = nullptr;
+    size_t len = 0;
+};
+
+typedef ArrayView<double> DataView;
+
+// Признаки цензуры (0 - отказ, 1 - цензурировано): либо int на наблюдение,
+// как в .inp, либо упакованные биты бинарного формата (бит i слова i/64).
+class CensView {
+public:
+    class iterator {
+    public:
+        iterator(const CensView* v, size_t i) : view(v), idx(i) {}
+        int operator*() const { return (*view)[idx]; }
+        iterator& operator++() { ++idx; return *this; }
+        bool operator!=(const iterator& o) const { return idx != o.idx; }
+    private:
+        const CensView* view;
+        size_t idx;
+    };
+
+    CensView() {}
+    CensView(const std::vector<int>& v) : ints(v.data()), len(v.size()) {}
+    CensView(const int* p, size_t n) : ints(p), len(n) {}
+    static CensView fromBits(const uint64_t* words, size_t n) {
+        CensView v;
+        v.bits = words;
+        v.len = n;
+        return v;
+    }
+
+    size_t size() const { return len; }
+    bool empty() const { return len == 0; }
+    int operator[](size_t i) const {
+        return ints ? ints[i] : static_cast<int>((bits[i >> 6] >> (i & 63)) & 1u);
+    }
+    iterator begin() const { return iterator(this, 0); }
+    iterator end() const { return iterator(this, len); }
+
+private:
+    const int* ints = nullptr;
+    const uint64_t* bits = nullptr;
+    size_t len = 0;
+};
+
+#endif // SAMPLEVIEW_H
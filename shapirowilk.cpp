@@ -0,0 +1,145 @@
+#include "shapirowilk.h"
+#include "normaldist.h"
+#include <cmath>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+static double poly(const double* c, int nord, double x) {
+    double r = c[nord - 1];
+    for (int i = nord - 2; i >= 0; --i) r = r * x + c[i];
+    return r;
+}
+
+static std::shared_ptr<const std::vector<double>> computeCoefficients(int n) {
+    const int half = n / 2;
+    std::vector<double> a(static_cast<size_t>(half));
+    if (n == 3) {
+        a[0] = std::sqrt(0.5);
+        return std::make_shared<const std::vector<double>>(std::move(a));
+    }
+
+    // m_i для нижней половины: (i - 3/8) / (n + 1/4), пакетом
+    std::vector<double> p(static_cast<size_t>(half)), m(static_cast<size_t>(half));
+    for (int i = 0; i < half; ++i) p[static_cast<size_t>(i)] = (i + 1 - 0.375) / (n + 0.25);
+    norm_ppf_batch(p.data(), m.data(), p.size());
+
+    double summ2 = 0;
+    for (double v : m) summ2 += v * v;
+    summ2 *= 2.0;
+    const double ssumm2 = std::sqrt(summ2), rsn = 1.0 / std::sqrt(static_cast<double>(n));
+
+    static const double c1[6] = {0.0, 0.221157, -0.147981, -2.07119, 4.434685, -2.706056};
+    static const double c2[6] = {0.0, 0.042981, -0.293762, -1.752461, 5.682633, -3.582633};
+    const double a1 = poly(c1, 6, rsn) - m[0] / ssumm2;
+
+    int first;
+    double fac;
+    if (n > 5) {
+        const double a2 = -m[1] / ssumm2 + poly(c2, 6, rsn);
+        fac = std::sqrt((summ2 - 2.0 * m[0] * m[0] - 2.0 * m[1] * m[1]) / (1.0 - 2.0 * a1 * a1 - 2.0 * a2 * a2));
+        a[1] = a2;
+        first = 2;
+    } else {
+        fac = std::sqrt((summ2 - 2.0 * m[0] * m[0]) / (1.0 - 2.0 * a1 * a1));
+        first = 1;
+    }
+    a[0] = a1;
+    for (int i = first; i < half; ++i) a[static_cast<size_t>(i)] = -m[static_cast<size_t>(i)] / fac;
+    return std::make_shared<const std::vector<double>>(std::move(a));
+}
+
+std::shared_ptr<const std::vector<double>> swilk_coefficients(int n) {
+    if (n < 3) return nullptr;
+    static const size_t kCapacity = 32;
+    static std::mutex mu;
+    static std::list<std::pair<int, std::shared_ptr<const std::vector<double>>>> lru; // голова - самый свежий
+    static std::unordered_map<int, decltype(lru)::iterator> index;
+
+    {
+        std::lock_guard<std::mutex> lock(mu);
+        auto it = index.find(n);
+        if (it != index.end()) {
+            lru.splice(lru.begin(), lru, it->second);
+            return it->second->second;
+        }
+    }
+
+    std::shared_ptr<const std::vector<double>> a = computeCoefficients(n);
+    std::lock_guard<std::mutex> lock(mu);
+    auto it = index.find(n);
+    if (it != index.end()) return it->second->second; // другой поток успел раньше
+    lru.emplace_front(n, a);
+    index[n] = lru.begin();
+    if (lru.size() > kCapacity) {
+        index.erase(lru.back().first);
+        lru.pop_back();
+    }
+    return a;
+}
+
+double swilk_statistic(const double* x, int n, const std::vector<double>& a) {
+    double mean = 0;
+    for (int i = 0; i < n; ++i) mean += x[i];
+    mean /= n;
+    double ss = 0;
+    for (int i = 0; i < n; ++i) ss += (x[i] - mean) * (x[i] - mean);
+    if (ss <= 0) return 1.0;
+
+    double b = 0;
+    for (size_t i = 0; i < a.size(); ++i) b += a[i] * (x[n - 1 - static_cast<int>(i)] - x[i]);
+    return std::min(1.0, b * b / ss);
+}
+
+// Параметры нормализующего преобразования: y = ln(1 - W) (n >= 12)
+// или y = -ln(gamma - ln(1 - W)) (4 <= n <= 11) ~ N(mu, sigma)
+static void roystonParams(int n, double& gamma, double& mu, double& sigma) {
+    static const double g[2] = {-2.273, 0.459};
+    static const double c3[4] = {0.544, -0.39978, 0.025054, -6.714e-4};
+    static const double c4[4] = {1.3822, -0.77857, 0.062767, -0.0020322};
+    static const double c5[4] = {-1.5861, -0.31082, -0.083751, 0.0038915};
+    static const double c6[3] = {-0.4803, -0.082676, 0.0030302};
+    const double an = n;
+    if (n <= 11) {
+        gamma = poly(g, 2, an);
+        mu = poly(c3, 4, an);
+        sigma = std::exp(poly(c4, 4, an));
+    } else {
+        const double xx = std::log(an);
+        gamma = 0;
+        mu = poly(c5, 4, xx);
+        sigma = std::exp(poly(c6, 3, xx));
+    }
+}
+
+static const double kPi6 = 1.90985931710274;   // 6 / pi
+static const double kStqr = 1.04719755119660;  // pi / 3
+
+double swilk_pvalue(double w, int n) {
+    if (n < 3) return 1.0;
+    if (n == 3) return std::max(0.0, std::min(1.0, kPi6 * (std::asin(std::sqrt(w)) - kStqr)));
+    if (w >= 1.0) return 1.0;
+
+    double gamma, mu, sigma;
+    roystonParams(n, gamma, mu, sigma);
+    double y = std::log(1.0 - w);
+    if (n <= 11) {
+        if (y >= gamma) return 1e-99;
+        y = -std::log(gamma - y);
+    }
+    return 0.5 * std::erfc((y - mu) / (sigma * std::sqrt(2.0)));
+}
+
+double swilk_critical(double alpha, int n) {
+    if (n < 3) return 0.0;
+    if (n == 3) {
+        double s = std::sin(alpha / kPi6 + kStqr);
+        return s * s;
+    }
+    double gamma, mu, sigma;
+    roystonParams(n, gamma, mu, sigma);
+    double y = mu + sigma * norm_ppf_as241(1.0 - alpha);
+    if (n <= 11) y = gamma - std::exp(-y);
+    return 1.0 - std::exp(y);
+}
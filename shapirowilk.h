@@ -0,0 +1,22 @@
+#ifndef SHAPIROWILK_H
+#define SHAPIROWILK_H
+
+#include <memory>
+#include <vector>
+
+// Критерий Шапиро-Уилка по Ройстону (AS R94), 3 <= n <= 5000.
+// Коэффициенты a_1..a_{n/2} (для верхней половины вариационного ряда)
+// кешируются по n с вытеснением давно не использованных (LRU), так что
+// повторный тест на том же объеме - это один проход по выборке.
+std::shared_ptr<const std::vector<double>> swilk_coefficients(int n);
+
+// W по упорядоченной выборке
+double swilk_statistic(const double* sorted, int n, const std::vector<double>& a);
+
+// P(W' <= w) при нормальности (нормализующее преобразование Ройстона)
+double swilk_pvalue(double w, int n);
+
+// Критическое значение уровня alpha из того же преобразования
+double swilk_critical(double alpha, int n);
+
+#endif // SHAPIROWILK_H
@@ -0,0 +1,61 @@
+#ifndef SIMDEXP_H
+#define SIMDEXP_H
+
+// Векторные экспоненты AVX2 / AVX-512 для ядер с выбором реализации по
+// процессору (weibullkernel, normaldist). Функции помечены target, поэтому
+// файл собирается без -mavx2, а вызываются только после проверки
+// __builtin_cpu_supports.
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SIMDEXP_X86 1
+#include <immintrin.h>
+
+// Векторная экспонента для t <= 0: t = k ln2 + r, |r| <= ln2/2,
+// e^r - ряд Тейлора до r^12 (погрешность ~2e-16), 2^k собирается в битах порядка.
+// Аргумент ограничен снизу -708 (результат ~3e-308): исчезающе малые значения
+// вызывающий код обрабатывает сам.
+namespace {
+const double kLog2e = 1.4426950408889634;
+const double kLn2Hi = 0.6931471803691238;
+const double kLn2Lo = 1.9082149292705877e-10;
+const double kMagic = 6755399441055744.0; // 1.5 * 2^52: округление к целому в младших битах
+const double kMinArg = -708.0;
+const double kTaylor[13] = {
+    1.0, 1.0, 1.0 / 2, 1.0 / 6, 1.0 / 24, 1.0 / 120, 1.0 / 720, 1.0 / 5040, 1.0 / 40320,
+    1.0 / 362880, 1.0 / 3628800, 1.0 / 39916800, 1.0 / 479001600
+};
+}
+
+__attribute__((target("avx2,fma")))
+static inline __m256d exp_avx2(__m256d t) {
+    t = _mm256_max_pd(t, _mm256_set1_pd(kMinArg));
+    __m256d kd = _mm256_round_pd(_mm256_mul_pd(t, _mm256_set1_pd(kLog2e)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256d r = _mm256_fnmadd_pd(kd, _mm256_set1_pd(kLn2Hi), t);
+    r = _mm256_fnmadd_pd(kd, _mm256_set1_pd(kLn2Lo), r);
+
+    __m256d p = _mm256_set1_pd(kTaylor[12]);
+    for (int j = 11; j >= 0; --j) p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(kTaylor[j]));
+
+    __m256i ki = _mm256_castpd_si256(_mm256_add_pd(kd, _mm256_set1_pd(kMagic)));
+    __m256i e2k = _mm256_slli_epi64(_mm256_add_epi64(ki, _mm256_set1_epi64x(1023)), 52);
+    return _mm256_mul_pd(p, _mm256_castsi256_pd(e2k));
+}
+
+__attribute__((target("avx512f")))
+static inline __m512d exp_avx512(__m512d t) {
+    t = _mm512_max_pd(t, _mm512_set1_pd(kMinArg));
+    __m512d kd = _mm512_roundscale_pd(_mm512_mul_pd(t, _mm512_set1_pd(kLog2e)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m512d r = _mm512_fnmadd_pd(kd, _mm512_set1_pd(kLn2Hi), t);
+    r = _mm512_fnmadd_pd(kd, _mm512_set1_pd(kLn2Lo), r);
+
+    __m512d p = _mm512_set1_pd(kTaylor[12]);
+    for (int j = 11; j >= 0; --j) p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(kTaylor[j]));
+
+    __m512i ki = _mm512_castpd_si512(_mm512_add_pd(kd, _mm512_set1_pd(kMagic)));
+    __m512i e2k = _mm512_slli_epi64(_mm512_add_epi64(ki, _mm512_set1_epi64(1023)), 52);
+    return _mm512_mul_pd(p, _mm512_castsi512_pd(e2k));
+}
+
+#endif // SIMDEXP_X86
+
+#endif // SIMDEXP_H
@@ -0,0 +1,239 @@
+#include "streamingfit.h"
+#include "analysis.h"
+#include "inpformat.h"
+#include "weibullkernel.h"
+#include <algorithm>
+#include <cmath>
+
+bool InpChunkReader::TokenCursor::open(const std::string& path) {
+    in.open(path, std::ios::binary);
+    buf.resize(1 << 16);
+    return static_cast<bool>(in);
+}
+
+void InpChunkReader::TokenCursor::seek(std::streamoff off) {
+    in.clear();
+    in.seekg(off);
+    pos = len = 0;
+    base = off;
+}
+
+bool InpChunkReader::TokenCursor::next() {
+    token.clear();
+    for (;;) {
+        if (pos == len) {
+            base += static_cast<std::streamoff>(len);
+            in.read(buf.data(), static_cast<std::streamsize>(buf.size()));
+            len = static_cast<size_t>(in.gcount());
+            pos = 0;
+            if (len == 0) return !token.empty();
+        }
+        char c = buf[pos];
+        if (inpIsSeparator(c)) {
+            ++pos;
+            if (!token.empty()) return true;
+        } else {
+            token += c;
+            ++pos;
+        }
+    }
+}
+
+bool InpChunkReader::open(const std::string& p, std::string& error) {
+    path = p;
+    if (!dataCur.open(path) || !censCur.open(path)) { error = path + ": не удалось открыть"; return false; }
+
+    // Один проход по файлу: запоминаем смещения блоков, числа не разбираем
+    TokenCursor scan;
+    scan.open(path);
+    bool expectN = false;
+    while (scan.next()) {
+        const std::streamoff consumed = scan.offset();
+        const std::string& t = scan.token;
+        if (expectN) { inpToInt(t.data(), t.data() + t.size(), declaredN); expectN = false; }
+        else if (t == "Samples_size") expectN = true;
+        else if (dataPos < 0 && (t == "Data" || t == "X")) dataPos = consumed;
+        else if (dataPos >= 0 && (t == "Censorizes" || t == "R")) { censPos = consumed; break; }
+    }
+    if (dataPos < 0) { error = path + ": нет блока Data"; return false; }
+    rewind();
+    return true;
+}
+
+void InpChunkReader::rewind() {
+    dataCur.seek(dataPos);
+    if (censPos >= 0) censCur.seek(censPos);
+    readN = 0;
+    dataDone = false;
+}
+
+bool InpChunkReader::next(std::vector<double>& x, std::vector<int>& r, size_t maxCount) {
+    x.clear();
+    r.clear();
+    while (!dataDone && x.size() < maxCount) {
+        if (declaredN >= 0 && readN >= declaredN) { dataDone = true; break; }
+        if (!dataCur.next()) { dataDone = true; break; }
+        const std::string& t = dataCur.token;
+        double v;
+        if (!inpToDouble(t.data(), t.data() + t.size(), v)) { dataDone = true; break; } // следующий блок
+        x.push_back(v);
+        ++readN;
+
+        long long ri = 0;
+        if (censPos >= 0 && censCur.next()) inpToInt(censCur.token.data(), censCur.token.data() + censCur.token.size(), ri);
+        r.push_back(static_cast<int>(ri));
+    }
+    return !x.empty();
+}
+
+// ВЕЙБУЛЛ ПОТОКОМ
+// Проход 1: число отказов, max ln x и моменты логарифмов отказов (старт Ньютона).
+// Далее по проходу на итерацию Ньютона с тем же ядром weibull_sums и той же
+// вилкой, что и в памяти: суммы по всем наблюдениям, сумма логарифмов - по отказам.
+bool weibull_mle_stream(SampleChunkSource& src, StreamFitResult& res, size_t chunk) {
+    std::vector<double> x, d;
+    std::vector<int> r;
+    res = StreamFitResult();
+
+    // Среднее и дисперсия ln x отказов - по Уэлфорду
+    double meanL = 0, M2 = 0, lmax = -HUGE_VAL;
+    std::vector<double> firstFails;   // первые два отказа - для фолбэка
+    src.rewind();
+    while (src.next(x, r, chunk)) {
+        res.n += x.size();
+        for (size_t i = 0; i < x.size(); ++i) {
+            if (x[i] <= 0) continue;
+            double l = std::log(x[i]);
+            lmax = std::max(lmax, l);
+            if (r[i] != 0) continue;
+            if (firstFails.size() < 2) firstFails.push_back(x[i]);
+            ++res.n_fail;
+            double delta = l - meanL;
+            meanL += delta / static_cast<double>(res.n_fail);
+            M2 += delta * (l - meanL);
+        }
+    }
+    res.passes = 1;
+    if (res.n == 0) return false;
+    if (res.n_fail < 2) {
+        // Как в памяти: weibull_regression_fallback и единичная ковариация.
+        // У Каплана-Мейера ступени только в отказах, их здесь не больше одной,
+        // поэтому регрессия по самим отказам совпадает с регрессией по выборке.
+        const std::vector<int> failR(firstFails.size(), 0);
+        auto est = weibull_regression_fallback(firstFails, failR);
+        res.p1 = est.first;
+        res.p2 = est.second;
+        res.cov = cov_weibull_observed(firstFails, failR, est.first, est.second).first;
+        return true;
+    }
+
+    const double nf = static_cast<double>(res.n_fail);
+    const double varL = M2 / nf;
+    const double L = nf * (meanL - lmax); // сумма сдвинутых логарифмов отказов
+
+    auto sumsPass = [&](double b) {
+        WeibullSums s;
+        src.rewind();
+        while (src.next(x, r, chunk)) {
+            d.clear();
+            for (double v : x) if (v > 0) d.push_back(std::log(v) - lmax);
+            WeibullSums c = weibull_sums(d.data(), d.size(), b);
+            s.S0 += c.S0; s.S1 += c.S1; s.S2 += c.S2;
+        }
+        ++res.passes;
+        return s;
+    };
+
+    // Старт - моментная оценка: Var(ln X) = pi^2 / (6 b^2)
+    double b = varL > 0 ? 3.14159265358979323846 / std::sqrt(6.0 * varL) : 1.0;
+    double lo = 0, hi = HUGE_VAL;
+    for (int it = 0; it < 100; ++it) {
+        WeibullSums s = sumsPass(b);
+        double g = nf/b + L - nf*s.S1/s.S0;
+        double dg = -nf/(b*b) - nf*(s.S2*s.S0 - s.S1*s.S1)/(s.S0*s.S0);
+        if (g > 0) lo = b; else hi = b;
+
+        double step = g/dg;
+        if (std::abs(step) < 1e-10*b) { b -= step; break; }
+        b -= step;
+        if (!(b > lo && b < hi)) b = std::isfinite(hi) ? 0.5*(lo + hi) : 2.0*lo;
+    }
+    // Последний проход дает и c, и суммы для наблюдаемой информации
+    WeibullSums s = sumsPass(b);
+    res.p1 = std::exp(lmax) * std::pow(s.S0/nf, 1.0/b);
+    res.p2 = b;
+    res.cov = weibull_observed_cov(s, L, nf, lmax, res.p1, b);
+    return true;
+}
+
+// НОРМАЛЬНОЕ ПОТОКОМ
+// Проход 1: моменты всей выборки и отказов (порции объединяются формулой Чана).
+// Без цензуры это и есть оценка; иначе по проходу на итерацию Ньютона
+// normal_mle_censored, в каждом - только цензурированные значения.
+bool normal_mle_stream(SampleChunkSource& src, StreamFitResult& res, size_t chunk) {
+    std::vector<double> x, xs;
+    std::vector<int> r;
+    res = StreamFitResult();
+
+    // Объединение моментов порции (cn, cmean, cM2) с накопленными (n0, mean, M2)
+    auto merge = [](double& n0, double& mean, double& M2, double cn, double cmean, double cM2) {
+        if (cn == 0) return;
+        double nt = n0 + cn, delta = cmean - mean;
+        mean += delta * cn / nt;
+        M2 += cM2 + delta * delta * n0 * cn / nt;
+        n0 = nt;
+    };
+
+    double nAll = 0, mean = 0, M2 = 0;
+    NormalFailMoments fail;
+    src.rewind();
+    while (src.next(x, r, chunk)) {
+        double cn = 0, cmean = 0, cM2 = 0, fn = 0, fmean = 0, fM2 = 0;
+        for (size_t i = 0; i < x.size(); ++i) {
+            cmean += x[i];
+            if (r[i] == 0) { fmean += x[i]; ++fn; }
+        }
+        cn = static_cast<double>(x.size());
+        cmean /= cn;
+        if (fn > 0) fmean /= fn;
+        for (size_t i = 0; i < x.size(); ++i) {
+            cM2 += (x[i] - cmean) * (x[i] - cmean);
+            if (r[i] == 0) fM2 += (x[i] - fmean) * (x[i] - fmean);
+        }
+        merge(nAll, mean, M2, cn, cmean, cM2);
+        merge(fail.r, fail.mean, fail.M2, fn, fmean, fM2);
+        res.n += x.size();
+    }
+    res.n_fail = static_cast<size_t>(fail.r);
+    res.passes = 1;
+    if (res.n == 0) return false;
+
+    const double n = static_cast<double>(res.n);
+    res.p1 = mean;
+    res.p2 = std::sqrt(M2 / n);
+    if (res.n_fail == res.n || res.n_fail < 2) {
+        double var_a = (res.p2 * res.p2) / n;
+        double var_s = (res.p2 * res.p2) / (2.0 * n);
+        res.cov = {{var_a, 0.0}, {0.0, var_s}};
+        return true;
+    }
+
+    auto survPass = [&](double mu, double sigma) {
+        NormalSurvSums acc;
+        src.rewind();
+        while (src.next(x, r, chunk)) {
+            xs.clear();
+            for (size_t i = 0; i < x.size(); ++i) if (r[i] != 0) xs.push_back(x[i]);
+            normal_surv_sums(xs.data(), xs.size(), mu, sigma, acc);
+        }
+        ++res.passes;
+        return acc;
+    };
+
+    auto est = normal_mle_censored(fail, res.p1, res.p2, survPass);
+    if (!(std::isfinite(est.first) && std::isfinite(est.second) && est.second > 0)) return false;
+    res.p1 = est.first;
+    res.p2 = est.second;
+    res.cov = normal_observed_cov(fail, survPass(res.p1, res.p2), res.p1, res.p2);
+    return true;
+}
@@ -0,0 +1,67 @@
+#ifndef STREAMINGFIT_H
+#define STREAMINGFIT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Источник выборки порциями: память ограничена размером порции, а не выборки.
+// rewind() позволяет делать несколько проходов (итерации Ньютона).
+class SampleChunkSource {
+public:
+    virtual ~SampleChunkSource() {}
+    virtual void rewind() = 0;
+    // Следующая порция не длиннее maxCount; false - данные кончились
+    virtual bool next(std::vector<double>& x, std::vector<int>& r, size_t maxCount) = 0;
+};
+
+// Порционное чтение блоков Data/Censorizes из .inp: два курсора по одному
+// файлу, поэтому цензура читается синхронно с данными без загрузки блока целиком.
+// Если блока Censorizes нет, все наблюдения считаются отказами.
+class InpChunkReader : public SampleChunkSource {
+public:
+    bool open(const std::string& path, std::string& error);
+    void rewind() override;
+    bool next(std::vector<double>& x, std::vector<int>& r, size_t maxCount) override;
+
+private:
+    // Буферизованный курсор по лексемам (разделители - пробелы, ',' и ';')
+    struct TokenCursor {
+        std::ifstream in;
+        std::vector<char> buf;
+        size_t pos = 0, len = 0;
+        std::streamoff base = 0; // смещение buf[0] в файле
+        std::string token;
+
+        bool open(const std::string& path);
+        void seek(std::streamoff off);
+        bool next(); // следующая лексема в token
+        std::streamoff offset() const { return base + static_cast<std::streamoff>(pos); }
+    };
+
+    std::string path;
+    TokenCursor dataCur, censCur;
+    std::streamoff dataPos = -1, censPos = -1;
+    long long declaredN = -1; // Samples_size, если указан
+    long long readN = 0;
+    bool dataDone = false;
+};
+
+// Оценки потокового режима. Совпадают с оценками в памяти
+// (weibull_mle_2par с cov_weibull_observed / normal_mle_2par с
+// cov_normal_observed) с относительной точностью ~1e-7, включая фолбэки
+// при меньше чем двух отказах. false - нет наблюдений или Ньютон разошелся.
+struct StreamFitResult {
+    double p1 = 0, p2 = 0;                   // c_hat, b_hat  или  a_hat, sigma_hat
+    std::vector<std::vector<double>> cov;
+    size_t n = 0;       // всего наблюдений
+    size_t n_fail = 0;  // из них отказов
+    int passes = 0;     // проходов по данным
+};
+
+bool weibull_mle_stream(SampleChunkSource& src, StreamFitResult& res, size_t chunk = size_t(1) << 20);
+bool normal_mle_stream(SampleChunkSource& src, StreamFitResult& res, size_t chunk = size_t(1) << 20);
+
+#endif // STREAMINGFIT_H
@@ -0,0 +1,218 @@
+#include "tukey.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <tuple>
+
+static const double kStep = 1.0 / 256;   // шаг таблицы P(R <= w)
+static const double kWMax = 16.0;        // дальше P(R <= w) = 1 до 1e-15
+
+// P(b < Z < a), a >= b, без потери точности в правом хвосте
+static double normalBetween(double a, double b) {
+    const double r = 0.70710678118654752440;
+    if (b >= 0) return 0.5 * (std::erfc(b * r) - std::erfc(a * r));
+    if (a <= 0) return 0.5 * (std::erfc(-a * r) - std::erfc(-b * r));
+    return 1.0 - 0.5 * (std::erfc(a * r) + std::erfc(-b * r));
+}
+
+// P(R <= w) для размаха k нормальных величин (wprob в ptukey R при rr = 1):
+// k * int ф(x) (Ф(x) - Ф(x - w))^(k-1) dx, интеграл от w/2 до 8 по 12 узлов
+// на 2-3 отрезках плюс (2Ф(w/2) - 1)^k
+static double rangeProbability(double w, int k) {
+    static const double xleg[6] = {
+        0.981560634246719250690549090149, 0.904117256370474856678465866119,
+        0.769902674194304687036893833213, 0.587317954286617447296702418941,
+        0.367831498998180193752691536644, 0.125233408511468915472441369464};
+    static const double aleg[6] = {
+        0.047175336386511827194615961485, 0.106939325995318430960254718194,
+        0.160078328543346226334652529543, 0.203167426723065921749064455810,
+        0.233492536538354808760849898925, 0.249147045813402785000562436043};
+    const double bb = 8.0;
+    const double qsqz = w * 0.5;
+    if (qsqz >= bb) return 1.0;
+
+    double pr = std::pow(normalBetween(qsqz, -qsqz), k);
+    const int wincr = w > 3.0 ? 2 : 3;
+    const double binc = (bb - qsqz) / wincr;
+    const double cc1 = k - 1.0;
+    const double tiny = std::exp(-30.0 / cc1);
+    double blb = qsqz, bub = qsqz + binc, einsum = 0;
+    for (int wi = 0; wi < wincr; ++wi) {
+        double elsum = 0;
+        const double a = 0.5 * (bub + blb), b = 0.5 * (bub - blb);
+        for (int jj = 0; jj < 12; ++jj) {
+            int j = jj < 6 ? jj : 11 - jj;
+            double xx = jj < 6 ? -xleg[j] : xleg[j];
+            double ac = a + b * xx;
+            double qexpo = ac * ac;
+            if (qexpo > 60.0) break;
+            double rinsum = normalBetween(ac, ac - w);
+            if (rinsum >= tiny) elsum += aleg[j] * std::exp(-0.5 * qexpo) * std::pow(rinsum, cc1);
+        }
+        einsum += elsum * (2.0 * b * k) * 0.39894228040143267794;
+        blb = bub;
+        bub += binc;
+    }
+    return std::min(1.0, pr + einsum);
+}
+
+StudentizedRange::StudentizedRange(int k_) : k(std::max(2, k_)) {
+    const size_t nodes = static_cast<size_t>(kWMax / kStep) + 1;
+    table.resize(nodes);
+    for (size_t i = 0; i < nodes; ++i) table[i] = rangeProbability(i * kStep, k);
+}
+
+// Кубический Лагранж по четырем соседним узлам равномерной сетки; u - в шагах
+static double interpolate(const std::vector<double>& y, double u) {
+    long i = static_cast<long>(u) - 1;
+    i = std::max(0L, std::min(i, static_cast<long>(y.size()) - 4));
+    const double t = u - i;
+    const double* p = y.data() + i;
+    return -p[0] * (t - 1) * (t - 2) * (t - 3) / 6.0
+           + p[1] * t * (t - 2) * (t - 3) / 2.0
+           - p[2] * t * (t - 1) * (t - 3) / 2.0
+           + p[3] * t * (t - 1) * (t - 2) / 6.0;
+}
+
+double StudentizedRange::rangeCdf(double w) const {
+    if (!(w > 0)) return 0.0;
+    if (w >= kWMax) return 1.0;
+    return std::min(1.0, std::max(0.0, interpolate(table, w / kStep)));
+}
+
+// Внешний интеграл по s: плотность s с df степенями свободы, отрезки
+// длины ulen по 16 узлов, пока вклад отрезка не станет пренебрежимым
+double StudentizedRange::cdf(double q, double df) const {
+    static const double xlegq[8] = {
+        0.989400934991649932596154173450, 0.944575023073232576077988415535,
+        0.865631202387831743880467897712, 0.755404408355003033895101194847,
+        0.617876244402643748446671764049, 0.458016777657227386342419442984,
+        0.281603550779258913230460501460, 0.950125098376374401853193354250e-1};
+    static const double alegq[8] = {
+        0.271524594117540948517805724560e-1, 0.622535239386478928628438369944e-1,
+        0.951585116824927848099251076022e-1, 0.124628971255533872052476282192,
+        0.149595988816576732081501730547, 0.169156519395002538189312079030,
+        0.182603415044923588866763667969, 0.189450610455068496285396723208};
+    if (!(q > 0)) return 0.0;
+    if (!(df >= 1)) return std::nan("");
+    if (df > 25000) return rangeCdf(q);
+
+    const double f2 = df * 0.5;
+    const double f21 = f2 - 1.0;
+    const double ff4 = df * 0.25;
+    const double ulen = df <= 100 ? 1.0 : df <= 800 ? 0.5 : df <= 5000 ? 0.25 : 0.125;
+    const double f2lf = f2 * std::log(df) - df * 0.69314718055994530942 - std::lgamma(f2) + std::log(ulen);
+
+    double ans = 0;
+    for (int i = 1; i <= 50; ++i) {
+        double otsum = 0;
+        const double twa1 = (2 * i - 1) * ulen;
+        for (int jj = 0; jj < 16; ++jj) {
+            int j = jj < 8 ? jj : jj - 8;
+            double x = jj < 8 ? twa1 - xlegq[j] * ulen : twa1 + xlegq[j] * ulen;
+            double t1 = f2lf + f21 * std::log(x) - x * ff4;
+            if (t1 >= -30.0) otsum += rangeCdf(q * std::sqrt(x * 0.5)) * alegq[j] * std::exp(t1);
+        }
+        if (i * ulen >= 1.0 && otsum <= 1e-14) break;
+        ans += otsum;
+    }
+    return std::min(1.0, ans);
+}
+
+double StudentizedRange::quantile(double p, double df) const {
+    if (!(p > 0 && p < 1) || !(df >= 1)) return std::nan("");
+    // Начальное приближение (qinv в qtukey R, Odeh & Evans для t)
+    double ps = 0.5 - 0.5 * p;
+    double yi = std::sqrt(std::log(1.0 / (ps * ps)));
+    double t = yi + ((((yi * -0.453642210148e-04 - 0.204231210125) * yi - 0.342242088547) * yi - 1.0) * yi + 0.322232421088)
+                  / ((((yi * 0.38560700634e-02 + 0.103537752850) * yi + 0.531103462366) * yi + 0.588581570495) * yi + 0.993484626060e-01);
+    if (df < 120) t += (t * t * t + t) / df / 4.0;
+    double c = 0.8832 - 0.2368 * t;
+    if (df < 120) c += -1.214 / df + 1.208 * t / df;
+    double x0 = std::max(0.1, t * (c * std::log(k - 1.0) + 1.4142));
+
+    // Вилка и ложное положение (Иллинойс)
+    double lo = x0, hi = x0;
+    double flo = cdf(lo, df) - p, fhi = flo;
+    for (int i = 0; flo > 0 && i < 60; ++i) { hi = lo; fhi = flo; lo *= 0.5; flo = cdf(lo, df) - p; }
+    for (int i = 0; fhi < 0 && i < 60; ++i) { lo = hi; flo = fhi; hi *= 1.5; fhi = cdf(hi, df) - p; }
+    if (!(flo <= 0 && fhi >= 0)) return std::nan("");
+    int side = 0;
+    for (int it = 0; it < 100 && hi - lo > 1e-12 * hi; ++it) {
+        double x = (lo * fhi - hi * flo) / (fhi - flo);
+        double fx = cdf(x, df) - p;
+        if (fx == 0) return x;
+        if (fx < 0) {
+            lo = x; flo = fx;
+            if (side == -1) fhi *= 0.5;
+            side = -1;
+        } else {
+            hi = x; fhi = fx;
+            if (side == 1) flo *= 0.5;
+            side = 1;
+        }
+    }
+    return 0.5 * (lo + hi);
+}
+
+std::shared_ptr<const StudentizedRange> studentized_range(int k) {
+    static std::mutex mu;
+    static std::map<int, std::shared_ptr<const StudentizedRange>> cache;
+    {
+        std::lock_guard<std::mutex> lock(mu);
+        auto it = cache.find(k);
+        if (it != cache.end()) return it->second;
+    }
+    // Табулируем вне блокировки; при гонке останется первая таблица
+    auto d = std::make_shared<const StudentizedRange>(k);
+    std::lock_guard<std::mutex> lock(mu);
+    if (cache.size() >= 64) cache.clear();
+    return cache.emplace(k, d).first->second;
+}
+
+double tukey_critical(double alpha, int k, double df) {
+    static std::mutex mu;
+    static std::map<std::tuple<double, int, double>, double> cache;
+    const auto key = std::make_tuple(alpha, k, df);
+    {
+        std::lock_guard<std::mutex> lock(mu);
+        auto it = cache.find(key);
+        if (it != cache.end()) return it->second;
+    }
+    double q = studentized_range(k)->quantile(1.0 - alpha, df);
+    std::lock_guard<std::mutex> lock(mu);
+    if (cache.size() >= 4096) cache.clear();
+    cache.emplace(key, q);
+    return q;
+}
+
+static const int kCritNodes = 128;       // отрезков по 1/df на (0, 1/2]
+
+TukeyCriticalTable::TukeyCriticalTable(double alpha_, int k)
+    : alpha(alpha_), dist(studentized_range(k)), nodes(kCritNodes + 1) {
+    for (int i = 0; i <= kCritNodes; ++i) {
+        double u = 0.5 * i / kCritNodes;
+        nodes[i] = dist->quantile(1.0 - alpha, i ? 1.0 / u : 1e9);
+    }
+}
+
+double TukeyCriticalTable::operator()(double df) const {
+    if (!(df >= 2)) return dist->quantile(1.0 - alpha, df);
+    return interpolate(nodes, (1.0 / df) / 0.5 * kCritNodes);
+}
+
+std::shared_ptr<const TukeyCriticalTable> tukey_critical_table(double alpha, int k) {
+    static std::mutex mu;
+    static std::map<std::pair<double, int>, std::shared_ptr<const TukeyCriticalTable>> cache;
+    const std::pair<double, int> key(alpha, k);
+    {
+        std::lock_guard<std::mutex> lock(mu);
+        auto it = cache.find(key);
+        if (it != cache.end()) return it->second;
+    }
+    auto t = std::make_shared<const TukeyCriticalTable>(alpha, k);
+    std::lock_guard<std::mutex> lock(mu);
+    if (cache.size() >= 64) cache.clear();
+    return cache.emplace(key, t).first->second;
+}
@@ -0,0 +1,53 @@
+#ifndef TUKEY_H
+#define TUKEY_H
+
+#include <memory>
+#include <vector>
+
+// Распределение стьюдентизированного размаха Q = (max - min) / s для k
+// независимых N(0, 1) и s^2 ~ chi^2(df)/df (критерии Тьюки и Геймса-Хауэлла).
+// Интегрирование - по алгоритму Copenhaver & Holland (1988), как в ptukey R:
+// внешний интеграл по s - Гаусс-Лежандр по 16 узлов на отрезках, внутренний
+// P(R <= w) при известном s - по 12 узлов. P(R <= w) зависит только от w и k,
+// поэтому при создании табулируется на [0, 16] и дальше интерполируется
+// кубически: вероятность Q стоит ~160 интерполяций вместо ~10^4 вызовов Ф.
+class StudentizedRange {
+public:
+    explicit StudentizedRange(int k);
+
+    int groups() const { return k; }
+    double rangeCdf(double w) const;                // P(R <= w), s = 1
+    double cdf(double q, double df) const;          // P(Q <= q), df >= 1
+    double sf(double q, double df) const { return 1.0 - cdf(q, df); }
+    double quantile(double p, double df) const;     // q с P(Q <= q) = p
+
+private:
+    int k;
+    std::vector<double> table;   // P(R <= w) в узлах с шагом kStep
+};
+
+// Таблица для k групп; кешируется по k
+std::shared_ptr<const StudentizedRange> studentized_range(int k);
+
+// Критическое значение q_(1 - alpha)(k, df); кешируется по (alpha, k, df)
+double tukey_critical(double alpha, int k, double df);
+
+// q_(1 - alpha)(k, df) при любых дробных df - для Геймса-Хауэлла, где у
+// каждой пары свои степени свободы. Таблица из 129 узлов по 1/df на (0, 1/2]
+// с кубической интерполяцией, относительная погрешность ~1e-6; df < 2 -
+// точным расчетом
+class TukeyCriticalTable {
+public:
+    TukeyCriticalTable(double alpha, int k);
+    double operator()(double df) const;
+
+private:
+    double alpha;
+    std::shared_ptr<const StudentizedRange> dist;
+    std::vector<double> nodes;
+};
+
+// Кешируется по (alpha, k)
+std::shared_ptr<const TukeyCriticalTable> tukey_critical_table(double alpha, int k);
+
+#endif // TUKEY_H
@@ -0,0 +1,93 @@
+#include "weibullkernel.h"
+#include "simdexp.h"
+#include <cmath>
+
+WeibullSums weibull_sums_scalar(const double* d, size_t n, double b) {
+    WeibullSums s;
+    for (size_t i = 0; i < n; ++i) {
+        double e = std::exp(b * d[i]);
+        s.S0 += e;
+        s.S1 += e * d[i];
+        s.S2 += e * d[i] * d[i];
+    }
+    return s;
+}
+
+#ifdef SIMDEXP_X86
+
+__attribute__((target("avx2,fma")))
+static WeibullSums weibull_sums_avx2(const double* d, size_t n, double b) {
+    __m256d vb = _mm256_set1_pd(b);
+    __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd(), s2 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d v = _mm256_loadu_pd(d + i);
+        __m256d e = exp_avx2(_mm256_mul_pd(vb, v));
+        __m256d ev = _mm256_mul_pd(e, v);
+        s0 = _mm256_add_pd(s0, e);
+        s1 = _mm256_add_pd(s1, ev);
+        s2 = _mm256_fmadd_pd(ev, v, s2);
+    }
+    alignas(32) double a0[4], a1[4], a2[4];
+    _mm256_store_pd(a0, s0); _mm256_store_pd(a1, s1); _mm256_store_pd(a2, s2);
+    WeibullSums tail = weibull_sums_scalar(d + i, n - i, b);
+    WeibullSums s;
+    s.S0 = (a0[0] + a0[1]) + (a0[2] + a0[3]) + tail.S0;
+    s.S1 = (a1[0] + a1[1]) + (a1[2] + a1[3]) + tail.S1;
+    s.S2 = (a2[0] + a2[1]) + (a2[2] + a2[3]) + tail.S2;
+    return s;
+}
+
+__attribute__((target("avx512f")))
+static WeibullSums weibull_sums_avx512(const double* d, size_t n, double b) {
+    __m512d vb = _mm512_set1_pd(b);
+    __m512d s0 = _mm512_setzero_pd(), s1 = _mm512_setzero_pd(), s2 = _mm512_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m512d v = _mm512_loadu_pd(d + i);
+        __m512d e = exp_avx512(_mm512_mul_pd(vb, v));
+        __m512d ev = _mm512_mul_pd(e, v);
+        s0 = _mm512_add_pd(s0, e);
+        s1 = _mm512_add_pd(s1, ev);
+        s2 = _mm512_fmadd_pd(ev, v, s2);
+    }
+    WeibullSums tail = weibull_sums_scalar(d + i, n - i, b);
+    WeibullSums s;
+    s.S0 = _mm512_reduce_add_pd(s0) + tail.S0;
+    s.S1 = _mm512_reduce_add_pd(s1) + tail.S1;
+    s.S2 = _mm512_reduce_add_pd(s2) + tail.S2;
+    return s;
+}
+
+#endif // SIMDEXP_X86
+
+namespace {
+typedef WeibullSums (*SumsFn)(const double*, size_t, double);
+
+struct KernelChoice {
+    SumsFn fn;
+    const char* name;
+};
+
+KernelChoice chooseKernel() {
+#ifdef SIMDEXP_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return {&weibull_sums_avx512, "avx512"};
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return {&weibull_sums_avx2, "avx2"};
+#endif
+    return {&weibull_sums_scalar, "scalar"};
+}
+
+const KernelChoice& kernel() {
+    static const KernelChoice k = chooseKernel();
+    return k;
+}
+}
+
+WeibullSums weibull_sums(const double* d, size_t n, double b) {
+    return kernel().fn(d, n, b);
+}
+
+const char* weibull_kernel_name() {
+    return kernel().name;
+}
@@ -0,0 +1,21 @@
+#ifndef WEIBULLKERNEL_H
+#define WEIBULLKERNEL_H
+
+#include <cstddef>
+
+// Суммы профильного уравнения Вейбулла при параметре формы b по сдвинутым
+// логарифмам d_i = ln x_i - max ln x (все d_i <= 0, поэтому e^{b d_i} <= 1):
+//   S0 = sum e^{b d_i},  S1 = sum e^{b d_i} d_i,  S2 = sum e^{b d_i} d_i^2
+struct WeibullSums {
+    double S0 = 0;
+    double S1 = 0;
+    double S2 = 0;
+};
+
+// Реализация (AVX-512 / AVX2+FMA / скалярная) выбирается один раз при первом
+// вызове по возможностям процессора.
+WeibullSums weibull_sums(const double* d, size_t n, double b);
+WeibullSums weibull_sums_scalar(const double* d, size_t n, double b);
+const char* weibull_kernel_name();
+
+#endif // WEIBULLKERNEL_H